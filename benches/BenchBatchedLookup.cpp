@@ -0,0 +1,119 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <thread>
+#include <fstream>
+#include "../src/Hashmap.h"
+
+namespace chrono = std::chrono;
+
+using std::cout;
+using std::vector;
+using std::thread;
+using std::ofstream;
+using std::pair;
+
+using tshm::Hashmap;
+
+#define sz(x) (int)(x).size()
+
+// One bucket per key, so nearly every lookup misses cache
+vector<int> LIM_TESTS = {100'000, 1'000'000, 4'000'000};
+vector<int> THREAD_TESTS = {1, 2, 4, 8};
+const int LOOKUPS = 4'000'000;
+const int REQUEST = 256;
+
+typedef Hashmap<int, int, ll::LockFreeLL> Map;
+
+// Look every key up once per thread, either one at a time or REQUEST at a time
+long long runOnce(Map &map, const vector<int> &lookups, int THREADS, bool batched) {
+	auto job = [&](int start, int end) {
+		vector<pair<bool, int>> out(REQUEST);
+		long long found = 0;
+		for (int i = start; i < end; i += REQUEST) {
+			int count = std::min(REQUEST, end - i);
+			if (batched) {
+				map.getMany(&lookups[i], count, out.data());
+			} else {
+				for (int j = 0; j < count; j++)
+					out[j] = map.get(lookups[i + j]);
+			}
+			for (int j = 0; j < count; j++)
+				found += out[j].first;
+		}
+		if (found != end - start)
+			cout << "Lookup missed!\n";
+	};
+
+	int gap = LOOKUPS / THREADS;
+	vector<thread> threads;
+
+	auto startTime = chrono::system_clock::now();
+
+	for (int thread = 0; thread < THREADS; thread++) {
+		int start = thread * gap;
+		threads.emplace_back(job, start, start + gap);
+	}
+	for (thread &t : threads)
+		t.join();
+
+	auto endTime = chrono::system_clock::now();
+
+	return chrono::duration_cast<chrono::milliseconds>(endTime - startTime).count();
+}
+
+int main() {
+	cout << "\n\nBENCHING BATCHED LOOKUP\n\n";
+
+	srand(time(NULL));
+
+	vector<vector<long long>> scalarResults(sz(LIM_TESTS), vector<long long>(sz(THREAD_TESTS)));
+	vector<vector<long long>> batchedResults(sz(LIM_TESTS), vector<long long>(sz(THREAD_TESTS)));
+
+	for (int j = 0; j < sz(LIM_TESTS); j++) {
+		int LIM = LIM_TESTS[j];
+		Map map(LIM);
+		for (int i = 0; i < LIM; i++)
+			map.put(i, i);
+
+		// Random hits, in an order the hardware prefetcher can't guess
+		vector<int> lookups(LOOKUPS);
+		for (int &x : lookups) x = rand() % LIM;
+
+		for (int k = 0; k < sz(THREAD_TESTS); k++) {
+			scalarResults[j][k] = runOnce(map, lookups, THREAD_TESTS[k], false);
+			batchedResults[j][k] = runOnce(map, lookups, THREAD_TESTS[k], true);
+		}
+	}
+
+	cout << "Results summary:\n";
+	cout << "----------------\n";
+
+	ofstream res("analysis/data/batched_lookup.csv");
+	res << "mode,limit,threads,runtime\n";
+	for (auto [name, results] : {
+		std::make_pair("scalar", &scalarResults),
+		std::make_pair("batched", &batchedResults)
+	}) {
+		cout << "Tests for " << name << " lookups\n";
+		printf("%-15s|", "Limit\\Threads");
+		for (int k = 0; k < sz(THREAD_TESTS); k++)
+			printf(" %-7d|", THREAD_TESTS[k]);
+		cout << "\n";
+		for (int j = 0; j < sz(LIM_TESTS); j++) {
+			printf("%-15d|", LIM_TESTS[j]);
+			for (int k = 0; k < sz(THREAD_TESTS); k++) {
+				printf(" %-5lldms|", (*results)[j][k]);
+				res <<
+					name << "," <<
+					LIM_TESTS[j] << "," <<
+					THREAD_TESTS[k] << "," <<
+					(*results)[j][k] << "\n";
+			}
+			cout << "\n";
+		}
+		cout << "\n";
+	}
+
+	res.close();
+}
@@ -0,0 +1,112 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <thread>
+#include <fstream>
+#include "../src/Hashmap.h"
+
+namespace chrono = std::chrono;
+
+using std::cout;
+using std::vector;
+using std::thread;
+using std::ofstream;
+
+using tshm::Hashmap;
+
+#define sz(x) (int)(x).size()
+
+const int LIM = 1'000'000;
+const int LOOKUPS = 4'000'000;
+const int BITS_PER_KEY = 10;
+vector<int> HIT_TESTS = {0, 10, 50, 90, 100};
+vector<int> THREAD_TESTS = {1, 2, 4, 8};
+
+typedef Hashmap<int, int, ll::AddOnlyLockFreeLL> Map;
+
+// Look every key up once, split across threads
+long long runOnce(Map &map, const vector<int> &lookups, int THREADS) {
+	auto job = [&](int start, int end) {
+		long long found = 0;
+		for (int i = start; i < end; i++)
+			found += map.get(lookups[i]).first;
+		if (found > end - start)
+			cout << "Impossible hit count!\n";
+	};
+
+	int gap = LOOKUPS / THREADS;
+	vector<thread> threads;
+
+	auto startTime = chrono::system_clock::now();
+
+	for (int thread = 0; thread < THREADS; thread++) {
+		int start = thread * gap;
+		threads.emplace_back(job, start, start + gap);
+	}
+	for (thread &t : threads)
+		t.join();
+
+	auto endTime = chrono::system_clock::now();
+
+	return chrono::duration_cast<chrono::milliseconds>(endTime - startTime).count();
+}
+
+int main() {
+	cout << "\n\nBENCHING BLOOM FILTER\n\n";
+
+	srand(time(NULL));
+
+	// Half as many buckets as keys, so misses walk a chain.
+	// Filters are sized by bucket count, so double the bits per key
+	Map plain(LIM / 2), filtered(LIM / 2, BITS_PER_KEY * 2);
+	for (int i = 0; i < LIM; i++) {
+		plain.put(i * 2, i);
+		filtered.put(i * 2, i);
+	}
+
+	vector<vector<long long>> plainResults(sz(HIT_TESTS), vector<long long>(sz(THREAD_TESTS)));
+	vector<vector<long long>> filteredResults(sz(HIT_TESTS), vector<long long>(sz(THREAD_TESTS)));
+
+	for (int j = 0; j < sz(HIT_TESTS); j++) {
+		// Misses are past every key we put, but land in the same buckets
+		vector<int> lookups(LOOKUPS);
+		for (int &x : lookups)
+			x = (rand() % LIM) * 2 + (rand() % 100 >= HIT_TESTS[j] ? 2 * LIM : 0);
+
+		for (int k = 0; k < sz(THREAD_TESTS); k++) {
+			plainResults[j][k] = runOnce(plain, lookups, THREAD_TESTS[k]);
+			filteredResults[j][k] = runOnce(filtered, lookups, THREAD_TESTS[k]);
+		}
+	}
+
+	cout << "Results summary:\n";
+	cout << "----------------\n";
+
+	ofstream res("analysis/data/bloom_filter.csv");
+	res << "filter,hit_rate,threads,runtime\n";
+	for (auto [name, results] : {
+		std::make_pair("none", &plainResults),
+		std::make_pair("bloom", &filteredResults)
+	}) {
+		cout << "Tests with filter " << name << "\n";
+		printf("%-15s|", "Hit%\\Threads");
+		for (int k = 0; k < sz(THREAD_TESTS); k++)
+			printf(" %-7d|", THREAD_TESTS[k]);
+		cout << "\n";
+		for (int j = 0; j < sz(HIT_TESTS); j++) {
+			printf("%-15d|", HIT_TESTS[j]);
+			for (int k = 0; k < sz(THREAD_TESTS); k++) {
+				printf(" %-5lldms|", (*results)[j][k]);
+				res <<
+					name << "," <<
+					HIT_TESTS[j] << "," <<
+					THREAD_TESTS[k] << "," <<
+					(*results)[j][k] << "\n";
+			}
+			cout << "\n";
+		}
+		cout << "\n";
+	}
+
+	res.close();
+}
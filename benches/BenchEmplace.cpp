@@ -0,0 +1,103 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <thread>
+#include <fstream>
+#include <string>
+#include "../src/Hashmap.h"
+
+namespace chrono = std::chrono;
+
+using std::cout;
+using std::vector;
+using std::thread;
+using std::ofstream;
+using std::string;
+
+using tshm::Hashmap;
+
+#define sz(x) (int)(x).size()
+
+const int CAPACITY = 250'000;
+const int VALUE_BYTES = 4'096;
+vector<int> LIM_TESTS = {50'000, 200'000};
+vector<int> THREAD_TESTS = {1, 2, 4, 8};
+
+// Ways to get a freshly built value into the map
+enum Mode { COPY, MOVE, EMPLACE };
+const char *MODE_NAMES[] = {"copy", "move", "emplace"};
+
+// Insert LIM heavy values, timed
+long long runOnce(Mode mode, int LIM, int THREADS) {
+	Hashmap<int, string, ll::LockFreeLL> map(CAPACITY);
+
+	auto job = [&](int start, int end) {
+		for (int i = start; i <= end; i++) {
+			if (mode == COPY) {
+				string val(VALUE_BYTES, 'a' + i % 26);
+				map.put(i, val);
+			} else if (mode == MOVE) {
+				string val(VALUE_BYTES, 'a' + i % 26);
+				map.put(int(i), std::move(val));
+			} else {
+				map.try_emplace(i, VALUE_BYTES, 'a' + i % 26);
+			}
+		}
+	};
+
+	int gap = LIM / THREADS;
+	vector<thread> threads;
+
+	auto startTime = chrono::system_clock::now();
+
+	for (int thread = 0; thread < THREADS; thread++) {
+		int start = thread * gap;
+		threads.emplace_back(job, start, start + gap - 1);
+	}
+	for (thread &t : threads)
+		t.join();
+
+	auto endTime = chrono::system_clock::now();
+
+	return chrono::duration_cast<chrono::milliseconds>(endTime - startTime).count();
+}
+
+int main() {
+	cout << "\n\nBENCHING EMPLACE\n\n";
+
+	vector<vector<vector<long long>>> results(3, vector<vector<long long>>(
+		sz(LIM_TESTS), vector<long long>(sz(THREAD_TESTS))));
+
+	for (int mode = COPY; mode <= EMPLACE; mode++)
+		for (int j = 0; j < sz(LIM_TESTS); j++)
+			for (int k = 0; k < sz(THREAD_TESTS); k++)
+				results[mode][j][k] = runOnce(Mode(mode), LIM_TESTS[j], THREAD_TESTS[k]);
+
+	cout << "Results summary:\n";
+	cout << "----------------\n";
+
+	ofstream res("analysis/data/emplace.csv");
+	res << "mode,limit,threads,runtime\n";
+	for (int mode = COPY; mode <= EMPLACE; mode++) {
+		cout << "Tests for " << MODE_NAMES[mode] << " inserts\n";
+		printf("%-15s|", "Limit\\Threads");
+		for (int k = 0; k < sz(THREAD_TESTS); k++)
+			printf(" %-7d|", THREAD_TESTS[k]);
+		cout << "\n";
+		for (int j = 0; j < sz(LIM_TESTS); j++) {
+			printf("%-15d|", LIM_TESTS[j]);
+			for (int k = 0; k < sz(THREAD_TESTS); k++) {
+				printf(" %-5lldms|", results[mode][j][k]);
+				res <<
+					MODE_NAMES[mode] << "," <<
+					LIM_TESTS[j] << "," <<
+					THREAD_TESTS[k] << "," <<
+					results[mode][j][k] << "\n";
+			}
+			cout << "\n";
+		}
+		cout << "\n";
+	}
+
+	res.close();
+}
@@ -3,7 +3,10 @@
 #include <vector>
 #include <thread>
 #include <fstream>
+#include <memory>
+#include <algorithm>
 #include "../src/Hashmap.h"
+#include "../src/FlatHashmap.h"
 
 namespace chrono = std::chrono;
 
@@ -13,6 +16,7 @@ using std::thread;
 using std::ofstream;
 
 using tshm::Hashmap;
+using tshm::FlatHashmap;
 
 #define sz(x) (int)(x).size()
 
@@ -20,14 +24,9 @@ vector<int> CAPACITY_TESTS = {25'000, 250'000, 2'500'000};
 vector<int> LIM_TESTS = {5'000, 50'000, 500'000};
 vector<int> THREAD_TESTS = {1, 2, 4, 8, 16, 20};
 
-int main() {
-	cout << "\n\nBENCHING HASHMAP\n\n";
-
-	// Get random numbers for use later
-	srand(time(NULL));
-	vector<int> randoms(LIM_TESTS.back());
-	for (int &x : randoms) x = rand();
-
+// Run every configuration against the map that makeMap builds
+template<class Map, class Make>
+vector<vector<vector<long long>>> runBench(const vector<int> &randoms, Make makeMap) {
 	vector<vector<vector<long long>>> results(
 			sz(CAPACITY_TESTS), vector<vector<long long>>(
 				sz(LIM_TESTS), vector<long long>(
@@ -41,16 +40,16 @@ int main() {
 				int LIM = LIM_TESTS[j];
 				int THREADS = THREAD_TESTS[k];
 
-				Hashmap<int, int, ll::LockFreeLL> map(CAPACITY);
+				std::unique_ptr<Map> map = makeMap(CAPACITY, LIM);
 
 				auto putJob = [&](int start, int end) {
 					for (int i = start; i <= end; i++)
-						map.put(randoms[i], i);
+						map->put(randoms[i], i);
 				};
 
 				auto removeJob = [&](int start, int end) {
 					for (int i = start; i <= end; i++)
-						map.remove(randoms[i]);
+						map->remove(randoms[i]);
 				};
 
 				int gap = LIM / THREADS;
@@ -60,8 +59,8 @@ int main() {
 
 				for (int thread = 0; thread < THREADS; thread++) {
 					int start = thread * gap;
-					threads.emplace_back(putJob, start, start + gap);
-					threads.emplace_back(removeJob, start, start + gap);
+					threads.emplace_back(putJob, start, start + gap - 1);
+					threads.emplace_back(removeJob, start, start + gap - 1);
 				}
 				for (thread &t : threads)
 					t.join();
@@ -74,10 +73,15 @@ int main() {
 		}
 	}
 
+	return results;
+}
+
+// Print a summary table and write the csv
+void report(const vector<vector<vector<long long>>> &results, const char *path) {
 	cout << "Results summary:\n";
 	cout << "----------------\n";
 
-	ofstream res("analysis/data/hashmap.csv");
+	ofstream res(path);
 	res << "capacity,limit,threads,runtime\n";
 	for (int i = 0; i < sz(CAPACITY_TESTS); i++) {
 		cout << "Tests for capacity " << CAPACITY_TESTS[i] << "\n";
@@ -102,3 +106,29 @@ int main() {
 
 	res.close();
 }
+
+int main() {
+	cout << "\n\nBENCHING HASHMAP\n\n";
+
+	// Get random numbers for use later
+	srand(time(NULL));
+	vector<int> randoms(LIM_TESTS.back());
+	for (int &x : randoms) x = rand();
+
+	typedef Hashmap<int, int, ll::LockFreeLL> ChainedMap;
+	report(runBench<ChainedMap>(randoms, [](int capacity, int) {
+		return std::make_unique<ChainedMap>(capacity);
+	}), "analysis/data/hashmap.csv");
+
+	cout << "\n\nBENCHING SORTED HASHMAP\n\n";
+	typedef Hashmap<int, int, ll::SortedLockFreeLL> SortedMap;
+	report(runBench<SortedMap>(randoms, [](int capacity, int) {
+		return std::make_unique<SortedMap>(capacity);
+	}), "analysis/data/sorted_hashmap.csv");
+
+	// The flat table can't chain past its capacity, so give it room for every key
+	cout << "\n\nBENCHING FLAT HASHMAP\n\n";
+	report(runBench<FlatHashmap<int, int>>(randoms, [](int capacity, int limit) {
+		return std::make_unique<FlatHashmap<int, int>>(std::max(capacity, 2 * limit));
+	}), "analysis/data/flat_hashmap.csv");
+}
@@ -0,0 +1,103 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <thread>
+#include <fstream>
+#include "../src/Hashmap.h"
+
+namespace chrono = std::chrono;
+
+using std::cout;
+using std::vector;
+using std::thread;
+using std::ofstream;
+
+using tshm::Hashmap;
+
+#define sz(x) (int)(x).size()
+
+const int CAPACITY = 250'000;
+vector<int> LIM_TESTS = {50'000, 500'000};
+vector<int> THREAD_TESTS = {1, 2, 4, 8, 16, 20};
+
+// Put then remove every key from a fresh map, timed
+template<class Alloc>
+long long runOnce(const vector<int> &randoms, int LIM, int THREADS) {
+	Hashmap<int, int, ll::LockFreeLL, std::hash<int>, Alloc> map(CAPACITY);
+
+	auto job = [&](int start, int end) {
+		for (int i = start; i <= end; i++)
+			map.put(randoms[i], i);
+		for (int i = start; i <= end; i++)
+			map.remove(randoms[i]);
+	};
+
+	int gap = LIM / THREADS;
+	vector<thread> threads;
+
+	auto startTime = chrono::system_clock::now();
+
+	for (int thread = 0; thread < THREADS; thread++) {
+		int start = thread * gap;
+		threads.emplace_back(job, start, start + gap - 1);
+	}
+	for (thread &t : threads)
+		t.join();
+
+	auto endTime = chrono::system_clock::now();
+
+	return chrono::duration_cast<chrono::milliseconds>(endTime - startTime).count();
+}
+
+int main() {
+	cout << "\n\nBENCHING NODE POOL\n\n";
+
+	// Get random numbers for use later
+	srand(time(NULL));
+	vector<int> randoms(LIM_TESTS.back());
+	for (int &x : randoms) x = rand();
+
+	vector<vector<long long>> heapResults(sz(LIM_TESTS), vector<long long>(sz(THREAD_TESTS)));
+	vector<vector<long long>> poolResults(sz(LIM_TESTS), vector<long long>(sz(THREAD_TESTS)));
+
+	for (int j = 0; j < sz(LIM_TESTS); j++) {
+		for (int k = 0; k < sz(THREAD_TESTS); k++) {
+			heapResults[j][k] = runOnce<alloc::HeapAllocator>(randoms, LIM_TESTS[j], THREAD_TESTS[k]);
+			poolResults[j][k] = runOnce<alloc::PooledAllocator>(randoms, LIM_TESTS[j], THREAD_TESTS[k]);
+		}
+	}
+
+	cout << "Results summary:\n";
+	cout << "----------------\n";
+
+	ofstream res("analysis/data/node_pool.csv");
+	res << "allocator,limit,threads,runtime\n";
+	for (auto [name, results] : {
+		std::make_pair("heap", &heapResults),
+		std::make_pair("pool", &poolResults)
+	}) {
+		cout << "Tests for allocator " << name << "\n";
+		printf("%-15s|", "Limit\\Threads");
+		for (int k = 0; k < sz(THREAD_TESTS); k++)
+			printf(" %-7d|", THREAD_TESTS[k]);
+		cout << "\n";
+		for (int j = 0; j < sz(LIM_TESTS); j++) {
+			printf("%-15d|", LIM_TESTS[j]);
+			for (int k = 0; k < sz(THREAD_TESTS); k++) {
+				printf(" %-5lldms|", (*results)[j][k]);
+				res <<
+					name << "," <<
+					LIM_TESTS[j] << "," <<
+					THREAD_TESTS[k] << "," <<
+					(*results)[j][k] << "\n";
+			}
+			cout << "\n";
+		}
+		cout << "\n";
+	}
+
+	auto footprint = alloc::PooledAllocator::footprint();
+	cout << "Pool reserved " << footprint.reservedBytes / 1024 << "KB\n";
+
+	res.close();
+}
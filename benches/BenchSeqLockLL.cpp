@@ -0,0 +1,112 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <thread>
+#include <fstream>
+#include <string>
+#include "../src/Hashmap.h"
+
+namespace chrono = std::chrono;
+
+using std::cout;
+using std::vector;
+using std::thread;
+using std::ofstream;
+using std::string;
+
+using tshm::Hashmap;
+
+#define sz(x) (int)(x).size()
+
+const int LIM = 1'000'000;
+const int OPS = 4'000'000;
+const int BUCKETS = LIM / 4; // A few nodes per bucket, so reads have a walk to do
+vector<int> WRITE_TESTS = {0, 5, 50};
+vector<int> THREAD_TESTS = {1, 2, 4, 8, 16, 20};
+
+// Mix of gets and puts over keys that are all present, split across threads
+template<class Map>
+long long runOnce(Map &map, const vector<int> &keys, int writePercent, int THREADS) {
+	auto job = [&](int start, int end) {
+		long long found = 0;
+		for (int i = start; i < end; i++) {
+			if (i % 100 < writePercent)
+				map.put(keys[i], i);
+			else
+				found += map.get(keys[i]).first;
+		}
+		if (found > end - start)
+			cout << "Impossible hit count!\n";
+	};
+
+	int gap = OPS / THREADS;
+	vector<thread> threads;
+
+	auto startTime = chrono::system_clock::now();
+
+	for (int thread = 0; thread < THREADS; thread++) {
+		int start = thread * gap;
+		threads.emplace_back(job, start, start + gap);
+	}
+	for (thread &t : threads)
+		t.join();
+
+	auto endTime = chrono::system_clock::now();
+
+	return chrono::duration_cast<chrono::milliseconds>(endTime - startTime).count();
+}
+
+template<template<class> class LL>
+void runAll(const vector<int> &present, const vector<int> &keys, vector<vector<long long>> &results) {
+	Hashmap<int, int, LL> map(BUCKETS);
+	for (int i = 0; i < LIM; i++)
+		map.put(present[i], i);
+	for (int j = 0; j < sz(WRITE_TESTS); j++) {
+		results.emplace_back(sz(THREAD_TESTS));
+		for (int k = 0; k < sz(THREAD_TESTS); k++)
+			results.back()[k] = runOnce(map, keys, WRITE_TESTS[j], THREAD_TESTS[k]);
+	}
+}
+
+int main() {
+	cout << "\n\nBENCHING SEQLOCK LINKED LIST\n\n";
+
+	srand(time(NULL));
+
+	vector<int> present(LIM);
+	for (int &x : present) x = rand();
+	vector<int> keys(OPS);
+	for (int &x : keys) x = present[rand() % LIM];
+
+	vector<string> names;
+	for (string list : {"lockable", "seqlock"})
+		for (int percent : WRITE_TESTS)
+			names.push_back(list + "-" + std::to_string(percent) + "%");
+
+	vector<vector<long long>> results;
+	runAll<ll::LockableLL>(present, keys, results);
+	runAll<ll::SeqLockLL>(present, keys, results);
+
+	cout << "Results summary:\n";
+	cout << "----------------\n";
+
+	ofstream res("analysis/data/seq_lock_ll.csv");
+	res << "list,threads,runtime\n";
+	printf("%-15s|", "List\\Threads");
+	for (int k = 0; k < sz(THREAD_TESTS); k++)
+		printf(" %-7d|", THREAD_TESTS[k]);
+	cout << "\n";
+	for (int j = 0; j < sz(names); j++) {
+		printf("%-15s|", names[j].c_str());
+		for (int k = 0; k < sz(THREAD_TESTS); k++) {
+			printf(" %-5lldms|", results[j][k]);
+			res <<
+				names[j] << "," <<
+				THREAD_TESTS[k] << "," <<
+				results[j][k] << "\n";
+		}
+		cout << "\n";
+	}
+
+	res.close();
+}
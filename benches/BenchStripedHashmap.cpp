@@ -0,0 +1,111 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <thread>
+#include <fstream>
+#include <string>
+#include "../src/Hashmap.h"
+#include "../src/StripedHashmap.h"
+
+namespace chrono = std::chrono;
+
+using std::cout;
+using std::vector;
+using std::thread;
+using std::ofstream;
+using std::string;
+
+using tshm::Hashmap;
+using tshm::StripedHashmap;
+
+#define sz(x) (int)(x).size()
+
+const int LIM = 1'000'000;
+const int OPS = 4'000'000;
+const int WRITE_PERCENT = 5;
+vector<int> STRIPE_TESTS = {1, 8, 64, 512};
+vector<int> THREAD_TESTS = {1, 2, 4, 8, 16, 20};
+
+// Read-mostly mix over keys that are all present, split across threads
+template<class Map>
+long long runOnce(Map &map, const vector<int> &keys, int THREADS) {
+	auto job = [&](int start, int end) {
+		long long found = 0;
+		for (int i = start; i < end; i++) {
+			if (i % 100 < WRITE_PERCENT)
+				map.put(keys[i], i);
+			else
+				found += map.get(keys[i]).first;
+		}
+		if (found > end - start)
+			cout << "Impossible hit count!\n";
+	};
+
+	int gap = OPS / THREADS;
+	vector<thread> threads;
+
+	auto startTime = chrono::system_clock::now();
+
+	for (int thread = 0; thread < THREADS; thread++) {
+		int start = thread * gap;
+		threads.emplace_back(job, start, start + gap);
+	}
+	for (thread &t : threads)
+		t.join();
+
+	auto endTime = chrono::system_clock::now();
+
+	return chrono::duration_cast<chrono::milliseconds>(endTime - startTime).count();
+}
+
+int main() {
+	cout << "\n\nBENCHING STRIPED HASHMAP\n\n";
+
+	srand(time(NULL));
+
+	vector<int> present(LIM);
+	for (int &x : present) x = rand();
+	vector<int> keys(OPS);
+	for (int &x : keys) x = present[rand() % LIM];
+
+	vector<string> names = {"lockable"};
+	vector<vector<long long>> results(1 + sz(STRIPE_TESTS), vector<long long>(sz(THREAD_TESTS)));
+
+	Hashmap<int, int, ll::LockableLL> lockable(LIM);
+	for (int i = 0; i < LIM; i++)
+		lockable.put(present[i], i);
+	for (int k = 0; k < sz(THREAD_TESTS); k++)
+		results[0][k] = runOnce(lockable, keys, THREAD_TESTS[k]);
+
+	for (int j = 0; j < sz(STRIPE_TESTS); j++) {
+		names.push_back("striped-" + std::to_string(STRIPE_TESTS[j]));
+		StripedHashmap<int, int> striped(LIM, STRIPE_TESTS[j]);
+		for (int i = 0; i < LIM; i++)
+			striped.put(present[i], i);
+		for (int k = 0; k < sz(THREAD_TESTS); k++)
+			results[j + 1][k] = runOnce(striped, keys, THREAD_TESTS[k]);
+	}
+
+	cout << "Results summary:\n";
+	cout << "----------------\n";
+
+	ofstream res("analysis/data/striped_hashmap.csv");
+	res << "map,threads,runtime\n";
+	printf("%-15s|", "Map\\Threads");
+	for (int k = 0; k < sz(THREAD_TESTS); k++)
+		printf(" %-7d|", THREAD_TESTS[k]);
+	cout << "\n";
+	for (int j = 0; j < sz(names); j++) {
+		printf("%-15s|", names[j].c_str());
+		for (int k = 0; k < sz(THREAD_TESTS); k++) {
+			printf(" %-5lldms|", results[j][k]);
+			res <<
+				names[j] << "," <<
+				THREAD_TESTS[k] << "," <<
+				results[j][k] << "\n";
+		}
+		cout << "\n";
+	}
+
+	res.close();
+}
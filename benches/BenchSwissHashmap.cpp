@@ -0,0 +1,115 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <thread>
+#include <fstream>
+#include "../src/Hashmap.h"
+#include "../src/FlatHashmap.h"
+#include "../src/SwissHashmap.h"
+
+namespace chrono = std::chrono;
+
+using std::cout;
+using std::vector;
+using std::thread;
+using std::ofstream;
+
+using tshm::Hashmap;
+using tshm::FlatHashmap;
+using tshm::SwissHashmap;
+
+#define sz(x) (int)(x).size()
+
+const int LIM = 1'000'000;
+const int OPS = 4'000'000;
+const int WRITE_PERCENT = 5;
+vector<int> THREAD_TESTS = {1, 2, 4, 8, 16, 20};
+
+// Read-mostly mix over keys that are all present, split across threads
+template<class Map>
+long long runOnce(Map &map, const vector<int> &keys, int THREADS) {
+	auto job = [&](int start, int end) {
+		long long found = 0;
+		for (int i = start; i < end; i++) {
+			if (keys[i] % 100 < WRITE_PERCENT)
+				map.put(keys[i], i);
+			else
+				found += map.get(keys[i]).first;
+		}
+		if (found > end - start)
+			cout << "Impossible hit count!\n";
+	};
+
+	int gap = OPS / THREADS;
+	vector<thread> threads;
+
+	auto startTime = chrono::system_clock::now();
+
+	for (int thread = 0; thread < THREADS; thread++) {
+		int start = thread * gap;
+		threads.emplace_back(job, start, start + gap);
+	}
+	for (thread &t : threads)
+		t.join();
+
+	auto endTime = chrono::system_clock::now();
+
+	return chrono::duration_cast<chrono::milliseconds>(endTime - startTime).count();
+}
+
+int main() {
+	cout << "\n\nBENCHING SWISS HASHMAP\n\n";
+
+	srand(time(NULL));
+
+	// Tables at about 60% load, the lists get a bucket per key
+	Hashmap<int, int, ll::AddOnlyLockFreeLL> lists(LIM);
+	FlatHashmap<int, int> flat(LIM * 5 / 3);
+	SwissHashmap<int, int> swiss(LIM * 5 / 3);
+
+	// Random keys, so std::hash being the identity doesn't line them up
+	vector<int> present(LIM);
+	for (int &x : present) x = rand();
+	for (int i = 0; i < LIM; i++) {
+		lists.put(present[i], i);
+		flat.put(present[i], i);
+		swiss.put(present[i], i);
+	}
+
+	vector<int> keys(OPS);
+	for (int &x : keys) x = present[rand() % LIM];
+
+	vector<long long> listResults(sz(THREAD_TESTS)), flatResults(sz(THREAD_TESTS)), swissResults(sz(THREAD_TESTS));
+	for (int k = 0; k < sz(THREAD_TESTS); k++) {
+		listResults[k] = runOnce(lists, keys, THREAD_TESTS[k]);
+		flatResults[k] = runOnce(flat, keys, THREAD_TESTS[k]);
+		swissResults[k] = runOnce(swiss, keys, THREAD_TESTS[k]);
+	}
+
+	cout << "Results summary:\n";
+	cout << "----------------\n";
+
+	ofstream res("analysis/data/swiss_hashmap.csv");
+	res << "map,threads,runtime\n";
+	printf("%-15s|", "Map\\Threads");
+	for (int k = 0; k < sz(THREAD_TESTS); k++)
+		printf(" %-7d|", THREAD_TESTS[k]);
+	cout << "\n";
+	for (auto [name, results] : {
+		std::make_pair("lists", &listResults),
+		std::make_pair("flat", &flatResults),
+		std::make_pair("swiss", &swissResults)
+	}) {
+		printf("%-15s|", name);
+		for (int k = 0; k < sz(THREAD_TESTS); k++) {
+			printf(" %-5lldms|", (*results)[k]);
+			res <<
+				name << "," <<
+				THREAD_TESTS[k] << "," <<
+				(*results)[k] << "\n";
+		}
+		cout << "\n";
+	}
+
+	res.close();
+}
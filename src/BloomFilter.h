@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include "StringHash.h"
+
+namespace bloom {
+
+	/* Lock free blocked bloom filter
+	 *
+	 * Every key maps to a single cache line sized block and sets one bit
+	 * in each of its eight words (a split block filter), so a lookup is
+	 * one cache miss and a handful of branch free instructions.
+	 * Inserts set bits with fetch_or and never clear any, so a key
+	 * that was inserted is never reported missing, while a key that
+	 * wasn't is reported present only at the false positive rate.
+	 * Works off a key's hash, not the key.
+	 */
+	class BlockedBloomFilter {
+	private:
+		static const size_t WORDS = 8, BLOCK_BITS = WORDS * 64;
+
+		struct alignas(64) Block {
+			std::atomic<uint64_t> words[WORDS];
+		};
+
+		// Private member variables
+		size_t blockCount;
+		std::unique_ptr<Block[]> blocks;
+
+		// Block a hash lands in, and the bit it sets in each word
+		Block &masksFor(size_t hash, uint64_t *masks) const {
+			static const uint64_t SALTS[WORDS] = {
+				0x47b6137b44974d91ULL, 0x8824ad5ba2b7289dULL,
+				0x705495c72df1424bULL, 0x9efc49475c6bfb31ULL,
+				0x3ad8a1c1b9e1f6c5ULL, 0xe2b7f2c5a4d3b6e7ULL,
+				0x5c6bfb319efc4947ULL, 0xa2b7289d8824ad5bULL
+			};
+
+			uint64_t mixed = tshm::mix64(hash);
+			Block &block = blocks[(unsigned __int128)mixed * blockCount >> 64];
+
+			// Top six bits of a different product pick the bit in each word
+			uint64_t bits = mixed ^ (mixed >> 32);
+			for (size_t i = 0; i < WORDS; i++)
+				masks[i] = 1ULL << ((bits * SALTS[i]) >> 58);
+			return block;
+		}
+
+	public:
+		// Size for expectedKeys keys at bitsPerKey bits each,
+		// about 1% false positives at 10 bits per key
+		BlockedBloomFilter(size_t expectedKeys, uint bitsPerKey) {
+			size_t bits = std::max<size_t>(expectedKeys, 1) * std::max(bitsPerKey, 1u);
+			blockCount = (bits + BLOCK_BITS - 1) / BLOCK_BITS;
+
+			blocks.reset(new Block[blockCount]);
+			for (size_t i = 0; i < blockCount; i++)
+				for (size_t j = 0; j < WORDS; j++)
+					blocks[i].words[j].store(0, std::memory_order_relaxed);
+		}
+
+		// Note a hash, skipping words that already have our bit
+		// so hot blocks aren't written over and over
+		void insert(size_t hash) {
+			uint64_t masks[WORDS];
+			Block &block = masksFor(hash, masks);
+			for (size_t i = 0; i < WORDS; i++)
+				if ((block.words[i].load(std::memory_order_relaxed) & masks[i]) == 0)
+					block.words[i].fetch_or(masks[i]);
+		}
+
+		// False only if hash was definitely never inserted
+		bool mayContain(size_t hash) const {
+			uint64_t masks[WORDS], missing = 0;
+			Block &block = masksFor(hash, masks);
+			for (size_t i = 0; i < WORDS; i++)
+				missing |= ~block.words[i].load() & masks[i];
+			return missing == 0;
+		}
+
+		// Bytes the bits take up
+		size_t bytes() const { return blockCount * sizeof(Block); }
+	};
+};
@@ -0,0 +1,289 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include "Hashmap.h"
+
+// Thread safe hashmap
+namespace tshm {
+
+	/* Open addressing hashmap over one contiguous slot array
+	 *
+	 * Keys and values are stored inline, so a lookup is a linear probe
+	 * through neighbouring slots instead of a pointer chase per entry.
+	 * Removal just clears the slot's live bit, so probe chains never break,
+	 * and the next key added along that chain takes the dead slot over.
+	 * Adding a new key takes a stripe lock picked by its home slot, so two
+	 * threads can't add the same key in different slots. Lookups,
+	 * overwrites and removals take no lock.
+	 *
+	 * Reads are optimistic: each slot carries a version that writers
+	 * bump, and readers retry if it moved underneath them. That requires
+	 * the value type to be trivially copyable. Keys change when a slot is
+	 * taken over, so they are compared the same way if they are trivially
+	 * copyable, and with the slot's writer bit held otherwise.
+	 *
+	 * The table does not grow; put throws std::length_error
+	 * once every slot holds a live key.
+	 */
+	template<
+		class K,
+		class V,
+		class F = std::hash<K>
+	>
+	class FlatHashmap : IHashmap<K, V> {
+		static_assert(
+			std::is_trivially_copyable<V>::value,
+			"FlatHashmap values are read optimistically and must be trivially copyable"
+		);
+
+	private:
+		// Slot control word layout
+		static const uint32_t BUSY = 1;    // A writer owns the slot
+		static const uint32_t CLAIMED = 2; // The slot has held a key, probes go past it
+		static const uint32_t LIVE = 4;    // The key and value are present
+		static const uint32_t VERSION = 8; // Version counter starts here
+
+		// Whether keys can be copied while a writer changes them
+		static const bool OPTIMISTIC_KEYS = std::is_trivially_copyable<K>::value;
+
+		struct Slot {
+			std::atomic<uint32_t> ctrl;
+			K key;
+			V val;
+
+			Slot() : ctrl(0) {}
+		};
+
+		struct alignas(64) Stripe {
+			std::mutex mtx;
+		};
+
+		// Private member variables
+		size_t capacity;
+		size_t mask;
+		F hash;
+		std::unique_ptr<Slot[]> slots;
+		size_t stripeMask;
+		std::unique_ptr<Stripe[]> stripes;
+		std::atomic<size_t> curSize;
+
+		// Wait out a writer, returning the control word it left
+		static uint32_t settle(Slot &slot) {
+			uint32_t ctrl = slot.ctrl.load(std::memory_order_acquire);
+			while (ctrl & BUSY) {
+				std::this_thread::yield();
+				ctrl = slot.ctrl.load(std::memory_order_acquire);
+			}
+			return ctrl;
+		}
+
+		// Take the writer bit, returning the old control word
+		static uint32_t lock(Slot &slot) {
+			uint32_t ctrl = slot.ctrl.load(std::memory_order_relaxed);
+			while (true) {
+				if (ctrl & BUSY) {
+					std::this_thread::yield();
+					ctrl = slot.ctrl.load(std::memory_order_relaxed);
+					continue;
+				}
+				if (slot.ctrl.compare_exchange_weak(
+					ctrl,
+					ctrl | BUSY,
+					std::memory_order_acquire
+				))
+					return ctrl;
+			}
+		}
+
+		// Release the writer bit and publish a new version
+		static void unlock(Slot &slot, uint32_t ctrl, bool live) {
+			uint32_t next = ((ctrl & ~(VERSION - 1)) + VERSION) | CLAIMED;
+			if (live)
+				next |= LIVE;
+			slot.ctrl.store(next, std::memory_order_release);
+		}
+
+		// Release the writer bit having changed nothing
+		static void release(Slot &slot, uint32_t ctrl) {
+			slot.ctrl.store(ctrl, std::memory_order_release);
+		}
+
+		// Whether a slot holds key live, copying its value into val if so
+		static bool holds(Slot &slot, const K &key, V *val = nullptr) {
+			if constexpr (OPTIMISTIC_KEYS) {
+				while (true) {
+					uint32_t before = settle(slot);
+					if (!(before & LIVE))
+						return false;
+
+					K seen = slot.key;
+					V copy = slot.val;
+					std::atomic_thread_fence(std::memory_order_acquire);
+
+					if (slot.ctrl.load(std::memory_order_relaxed) == before) {
+						if (!(seen == key))
+							return false;
+						if (val != nullptr)
+							*val = copy;
+						return true;
+					}
+				}
+			} else {
+				uint32_t ctrl = lock(slot);
+				bool held = (ctrl & LIVE) && slot.key == key;
+				if (held && val != nullptr)
+					*val = slot.val;
+				release(slot, ctrl);
+				return held;
+			}
+		}
+
+		/*
+		 * Slot holding key live, or null. On a miss free is the first slot
+		 * a new key could take, a dead one or the never used one that
+		 * ended the probe, and null if every slot is live.
+		 */
+		Slot *probe(const K &key, Slot *&free, uint32_t &freeCtrl) {
+			free = nullptr;
+			size_t index = hash(key) & mask;
+			for (size_t probes = 0; probes < capacity; probes++) {
+				Slot &slot = slots[index];
+				uint32_t ctrl = settle(slot);
+
+				if (!(ctrl & LIVE)) {
+					if (free == nullptr) {
+						free = &slot;
+						freeCtrl = ctrl;
+					}
+					if (ctrl == 0)
+						return nullptr;
+				} else if (holds(slot, key)) {
+					return &slot;
+				}
+
+				index = (index + 1) & mask;
+			}
+			return nullptr;
+		}
+
+		// Write val into a slot if it still holds key live
+		static bool overwrite(Slot &slot, const K &key, const V &val) {
+			uint32_t ctrl = lock(slot);
+			if (!(ctrl & LIVE) || !(slot.key == key)) {
+				release(slot, ctrl);
+				return false;
+			}
+			slot.val = val;
+			unlock(slot, ctrl, true);
+			return true;
+		}
+
+	public:
+		// Construct hashmap, capacity is rounded up to a power of two,
+		// and so is the stripe count of four per core
+		FlatHashmap(uint capacity) : capacity(1), stripeMask(1), curSize(0) {
+			while (this->capacity < capacity)
+				this->capacity <<= 1;
+			mask = this->capacity - 1;
+			slots.reset(new Slot[this->capacity]);
+
+			while (stripeMask < parallel::defaultThreads() * 4)
+				stripeMask <<= 1;
+			stripes.reset(new Stripe[stripeMask]);
+			stripeMask--;
+		}
+
+		// Nothing really interesting about the destructor
+		virtual ~FlatHashmap() {}
+
+		// Associate specified key with specified value
+		void put(const K &key, const V &val) {
+			Slot *free;
+			uint32_t freeCtrl;
+
+			// Already there, just overwrite the value
+			Slot *slot = probe(key, free, freeCtrl);
+			if (slot != nullptr && overwrite(*slot, key, val))
+				return;
+
+			// Nobody else adds our key while we hold its stripe,
+			// so a miss under it stays a miss until we add it
+			std::lock_guard<std::mutex> guard(stripes[hash(key) & mask & stripeMask].mtx);
+			while (true) {
+				slot = probe(key, free, freeCtrl);
+				if (slot != nullptr) {
+					if (overwrite(*slot, key, val))
+						return;
+					continue;
+				}
+
+				if (free == nullptr)
+					throw std::length_error("FlatHashmap is full");
+
+				// Someone else took it, look again
+				if (!free->ctrl.compare_exchange_strong(
+					freeCtrl,
+					freeCtrl | BUSY,
+					std::memory_order_acquire
+				))
+					continue;
+
+				free->key = key;
+				free->val = val;
+				unlock(*free, freeCtrl, true);
+				curSize++;
+				return;
+			}
+		}
+
+		// Return the status of containment and value
+		std::pair<bool, V> get(const K &key) {
+			size_t index = hash(key) & mask;
+			for (size_t probes = 0; probes < capacity; probes++) {
+				Slot &slot = slots[index];
+				uint32_t ctrl = settle(slot);
+				if (ctrl == 0)
+					break;
+
+				V val{};
+				if ((ctrl & LIVE) && holds(slot, key, &val))
+					return {true, val};
+
+				index = (index + 1) & mask;
+			}
+			return {false, V{}};
+		}
+
+		// Remove a key from the map
+		bool remove(const K &key) {
+			while (true) {
+				Slot *free;
+				uint32_t freeCtrl;
+				Slot *slot = probe(key, free, freeCtrl);
+				if (slot == nullptr)
+					return false;
+
+				uint32_t ctrl = lock(*slot);
+				if ((ctrl & LIVE) && slot->key == key) {
+					unlock(*slot, ctrl, false);
+					curSize--;
+					return true;
+				}
+
+				// Removed or taken over since we looked, look again
+				release(*slot, ctrl);
+			}
+		}
+
+		// Get current number of entries
+		size_t size() { return curSize; }
+
+		// Get the number of slots
+		size_t slotCount() { return capacity; }
+	};
+};
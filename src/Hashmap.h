@@ -1,9 +1,25 @@
+#pragma once
+
 #include <thread>
 #include <vector>
 #include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <optional>
 #include <assert.h>
-#include "Semaphore.h"
+#include "WorkQueue.h"
+#include "StringHash.h"
+#include "ValueCell.h"
+#include "BloomFilter.h"
 #include "LinkedList.h"
+#include "Parallel.h"
+#include "ShardedCounter.h"
 
 // Hashmap abstract
 template<class K, class V>
@@ -20,11 +36,15 @@ namespace tshm {
 	template<class K, class V>
 	struct Entry {
 		K key;
-		V val;
+		ValueCell<V> val; // Shared with other threads once linked in
 		Entry() {}
 		// Just key constructor for lookups
-		Entry(K key) : key(key) {}
-		Entry(K key, V val) : key(key), val(val) {}
+		Entry(K key) : key(std::move(key)) {}
+		Entry(K key, V val) : key(std::move(key)), val(std::in_place, std::move(val)) {}
+		// Build the key and value in place, the value from any args
+		template<class KArg, class... VArgs>
+		Entry(std::in_place_t, KArg &&key, VArgs&&... args)
+			: key(std::forward<KArg>(key)), val(std::in_place, std::forward<VArgs>(args)...) {}
 
 		/*
 		 * We equate entries on key so that we don't have duplicates.
@@ -34,70 +54,501 @@ namespace tshm {
 		bool operator==(const Entry &a) const { return key == a.key; }
 	};
 
+	// Stand in for an entry when probing, compares the key with anything
+	// the key type compares with, without copying or converting it
+	template<class Q>
+	struct KeyProbe {
+		const Q &key;
+	};
+
+	template<class K, class V, class Q>
+	bool operator==(const Entry<K, V> &entry, const KeyProbe<Q> &probe) {
+		return entry.key == probe.key;
+	}
+
+	// A put over an existing entry only swaps the value, the key
+	// stays put for anyone reading it
+	template<class K, class V>
+	void assignValue(Entry<K, V> &dst, const Entry<K, V> &src) {
+		dst.val.store(src.val.load());
+	}
+
+	// Src is private to the caller, so its value can be moved out
+	template<class K, class V>
+	void assignValue(Entry<K, V> &dst, Entry<K, V> &&src) {
+		dst.val.store(std::move(src.val.NOT_THREAD_SAFE_get()));
+	}
+
+	// Sorted buckets order entries by the hash of their key
+	template<class K, class V>
+	size_t hashOf(const Entry<K, V> &entry) {
+		return std::hash<K>()(entry.key);
+	}
+
 	/* Hashmap where we do *not* manage threads for the user
 	 *
 	 * Operations are sequentially consistent, but behavior
-	 * between close gets and sets is not defined
+	 * between close gets and sets is not defined.
+	 * Alloc picks how the buckets allocate their nodes.
 	 */
 	template<
 		class K,
 		class V,
 		template<class> class Container = ll::AddOnlyLockFreeLL,
-		class F = std::hash<K>
+		class F = std::hash<K>,
+		class Alloc = alloc::HeapAllocator
 	>
 	class Hashmap : IHashmap<K, V> {
 		// Less typing later
 		typedef Entry<K, V> TypedEntry;
+		typedef typename Container<TypedEntry>::template WithAllocator<Alloc> Bucket;
 
 	private:
 		// Private member variables
 		uint capacity;
 		F hash;
-		std::vector<Container<TypedEntry>> hashmap;
+		std::vector<Bucket> hashmap;
+		std::unique_ptr<bloom::BlockedBloomFilter> filter; // Null unless asked for
+		counter::ShardedCounter entries;
+
+		// Keys a batched call hashes and prefetches at once
+		static constexpr size_t PREFETCH_BATCH = 16;
+
+		// Wrapper method to extract index from a key's hash
+		size_t getIndex(size_t keyHash) const {
+			return keyHash % capacity;
+		}
+
+		// Bucket for a key we may add, noted in the filter before it can land
+		Bucket &bucketForAdd(size_t keyHash) {
+			if (filter)
+				filter->insert(keyHash);
+			return hashmap[getIndex(keyHash)];
+		}
+
+		// Keep the size in step with what a bucket did
+		bool countAdd(bool added) {
+			if (added)
+				entries.increment();
+			return added;
+		}
+		bool countRemove(bool removed) {
+			if (removed)
+				entries.decrement();
+			return removed;
+		}
 
-		// Wrapper method to extract index from key
-		size_t getHashedIndex(const K &key) const {
-			return hash(key) % capacity;
+		// False only if the key is definitely not in the map
+		bool mayContain(size_t keyHash) const {
+			return !filter || filter->mayContain(keyHash);
 		}
 
+		// Hash a chunk of keys and warm their buckets, return the chunk size
+		size_t prefetchChunk(const K *keys, size_t count, size_t *hashes, size_t *indices) const {
+			count = std::min(count, PREFETCH_BATCH);
+			for (size_t i = 0; i < count; i++) {
+				hashes[i] = hash(keys[i]);
+				indices[i] = getIndex(hashes[i]);
+			}
+			ll::prefetchBuckets(hashmap.data(), indices, count);
+			return count;
+		}
+
+		// Snapshot of an entry, for iterators
+		struct EntryToPair {
+			std::pair<K, V> operator()(const TypedEntry &entry) const { return {entry.key, entry.val.load()}; }
+		};
+
+		// Value for a key compute found missing, only worked out if a
+		// bucket actually builds a node with it
+		template<class Fn>
+		struct Computed {
+			Fn &fn;
+			V &result;
+			operator V() const { return result = fn(V{}); }
+		};
+
 	public:
-		// Construct hashmap
-		Hashmap(uint capacity) : capacity(capacity), hashmap(capacity) {}
+		// Weakly consistent iterator over key value copies, see begin
+		typedef ll::SnapshotIterator<Bucket, std::pair<K, V>, EntryToPair> Iterator;
+
+		/*
+		 * Construct hashmap. A non zero bloomBitsPerKey puts a bloom
+		 * filter sized for capacity keys in front of the buckets, so most
+		 * lookups of missing keys never touch them. About 10 bits per
+		 * key gives 1% false positives. Removed keys stay in the filter.
+		 */
+		Hashmap(uint capacity, uint bloomBitsPerKey = 0) : capacity(capacity), hashmap(capacity) {
+			if (bloomBitsPerKey > 0)
+				filter.reset(new bloom::BlockedBloomFilter(capacity, bloomBitsPerKey));
+		}
 
 		// Nothing really interesting about the destructor
 		virtual ~Hashmap() {}
 
 		// Associate specified key with specified value
 		void put(const K &key, const V &val) {
-			size_t index = getHashedIndex(key);
-			hashmap[index].add(TypedEntry(key, val));
+			putWithHash(key, val, hash(key));
+		}
+
+		// Same as above, moving the key and value into the bucket
+		void put(K &&key, V &&val) {
+			size_t keyHash = hash(key);
+			countAdd(bucketForAdd(keyHash).add(TypedEntry(std::move(key), std::move(val)), keyHash));
+		}
+
+		/*
+		 * Build the value from args right inside the bucket's new node,
+		 * only if key is missing. Existing values are left alone.
+		 * Returns whether we added it.
+		 */
+		template<class... Args>
+		bool try_emplace(const K &key, Args&&... args) {
+			size_t keyHash = hash(key);
+			return countAdd(bucketForAdd(keyHash).tryEmplace(KeyProbe<K>{key}, keyHash,
+				std::in_place, key, std::forward<Args>(args)...));
+		}
+
+		template<class... Args>
+		bool try_emplace(K &&key, Args&&... args) {
+			size_t keyHash = hash(key);
+			return countAdd(bucketForAdd(keyHash).tryEmplace(KeyProbe<K>{key}, keyHash,
+				std::in_place, std::move(key), std::forward<Args>(args)...));
+		}
+
+		/*
+		 * Build an entry from args, the key then the value's args, and
+		 * move it into the bucket if its key is missing.
+		 * Returns whether we added it.
+		 */
+		template<class... Args>
+		bool emplace(Args&&... args) {
+			TypedEntry entry(std::in_place, std::forward<Args>(args)...);
+			size_t keyHash = hash(entry.key);
+			return countAdd(bucketForAdd(keyHash).tryEmplace(entry, keyHash, std::move(entry)));
+		}
+
+		/*
+		 * Replace the value for key with fn(current), current being V{}
+		 * if key is missing. Concurrent computes on a key never lose each
+		 * other's results, but fn may run more than once so it must not
+		 * have side effects. Fn runs inside the bucket's operation, under
+		 * its lock for lock based buckets, so it must not call back into
+		 * this map. Returns the value we stored.
+		 */
+		template<class Fn>
+		V compute(const K &key, Fn &&fn) {
+			size_t keyHash = hash(key);
+			V result{};
+			countAdd(bucketForAdd(keyHash).findOrEmplace(KeyProbe<K>{key}, keyHash,
+				[&](TypedEntry &entry) { result = entry.val.update(fn); },
+				std::in_place, key, Computed<Fn>{fn, result}));
+			return result;
+		}
+
+		/*
+		 * Put delta if key is missing, otherwise replace the value with
+		 * fn(current, delta). Same rules for fn as compute, so it must
+		 * not call back into this map either. Returns the value we stored.
+		 */
+		template<class Fn>
+		V merge(const K &key, const V &delta, Fn &&fn) {
+			size_t keyHash = hash(key);
+			V result = delta;
+			countAdd(bucketForAdd(keyHash).findOrEmplace(KeyProbe<K>{key}, keyHash,
+				[&](TypedEntry &entry) {
+					result = entry.val.update([&](const V &current) { return fn(current, delta); });
+				},
+				std::in_place, key, delta));
+			return result;
+		}
+
+		/*
+		 * Add delta to the value for key, or put delta if it's missing.
+		 * Lock free for word sized values, see ValueCell.
+		 * Returns the value before, V{} if we put it.
+		 */
+		V fetchAdd(const K &key, const V &delta) {
+			size_t keyHash = hash(key);
+			V old{};
+			countAdd(bucketForAdd(keyHash).findOrEmplace(KeyProbe<K>{key}, keyHash,
+				[&](TypedEntry &entry) { old = entry.val.fetchAdd(delta); },
+				std::in_place, key, delta));
+			return old;
+		}
+
+		/*
+		 * Put val only if key is missing, in one pass over the bucket.
+		 * Returns whether key was already there, and its value if so.
+		 */
+		std::pair<bool, V> putIfAbsent(const K &key, const V &val) {
+			size_t keyHash = hash(key);
+			std::pair<bool, V> prior = {false, V{}};
+			countAdd(bucketForAdd(keyHash).findOrEmplace(KeyProbe<K>{key}, keyHash,
+				[&](TypedEntry &entry) { prior = {true, entry.val.load()}; },
+				std::in_place, key, val));
+			return prior;
+		}
+
+		/*
+		 * Put val whether or not key is there, like put.
+		 * Returns whether key was already there, and the value we replaced.
+		 */
+		std::pair<bool, V> exchange(const K &key, const V &val) {
+			size_t keyHash = hash(key);
+			std::pair<bool, V> prior = {false, V{}};
+			countAdd(bucketForAdd(keyHash).findOrEmplace(KeyProbe<K>{key}, keyHash,
+				[&](TypedEntry &entry) { prior = {true, entry.val.exchange(val)}; },
+				std::in_place, key, val));
+			return prior;
+		}
+
+		/*
+		 * Compare and set, swap in desired only if key maps to expected.
+		 * Missing keys are never added. Returns whether we swapped, and
+		 * the value we saw (V{} if key is missing).
+		 */
+		std::pair<bool, V> replace(const K &key, const V &expected, const V &desired) {
+			size_t keyHash = hash(key);
+			std::pair<bool, V> result = {false, V{}};
+			if (!mayContain(keyHash))
+				return result;
+			hashmap[getIndex(keyHash)].modify(KeyProbe<K>{key}, keyHash, [&](TypedEntry &entry) {
+				result.second = expected;
+				result.first = entry.val.compareExchange(result.second, desired);
+			});
+			return result;
 		}
 
 		// Return the status of containment and value
 		std::pair<bool, V> get(const K &key) {
-			size_t index = getHashedIndex(key);
+			return getWithHash(key, hash(key));
+		}
+
+		/*
+		 * Heterogeneous lookup, for when F is transparent (F::is_transparent).
+		 * Q can be anything F hashes like a K and K compares equal to,
+		 * e.g. std::string_view with tshm::StringHash.
+		 */
+		template<class Q, class H = F, class = typename H::is_transparent>
+		std::pair<bool, V> get(const Q &key) {
+			return getWithHash(key, hash(key));
+		}
 
-			TypedEntry entry(key);
-			if (hashmap[index].find(entry))
-				return {true, entry.val};
+		/*
+		 * Same as put and get, for callers that already hold the key's hash.
+		 * keyHash must be exactly what F gives for key, or the key lands
+		 * in the wrong bucket.
+		 */
+		void putWithHash(const K &key, const V &val, size_t keyHash) {
+			countAdd(bucketForAdd(keyHash).add(TypedEntry(key, val), keyHash));
+		}
+
+		// Key can also be anything that compares with K, see get
+		template<class Q = K>
+		std::pair<bool, V> getWithHash(const Q &key, size_t keyHash) {
+			std::pair<bool, V> result = {false, V{}};
+			visitWithHash(key, keyHash, [&](const V &val) {
+				result = {true, val};
+			});
+			return result;
+		}
+
+		/*
+		 * Hand the value stored for key to fn in place, without copying it.
+		 * The entry stays alive until fn returns even if it's removed
+		 * meanwhile, but fn must not hold on to the reference or call back
+		 * into this map. Returns whether the key was there.
+		 */
+		template<class Fn>
+		bool visit(const K &key, Fn &&fn) {
+			return visitWithHash(key, hash(key), std::forward<Fn>(fn));
+		}
 
-			return {false, V{}};
+		template<class Q, class Fn, class H = F, class = typename H::is_transparent>
+		bool visit(const Q &key, Fn &&fn) {
+			return visitWithHash(key, hash(key), std::forward<Fn>(fn));
+		}
+
+		template<class Q, class Fn>
+		bool visitWithHash(const Q &key, size_t keyHash, Fn &&fn) {
+			if (!mayContain(keyHash))
+				return false;
+			return hashmap[getIndex(keyHash)].visit(KeyProbe<Q>{key}, keyHash, [&](const TypedEntry &entry) {
+				entry.val.read(fn);
+			});
 		}
 
 		// Remove a key from the map, only works
 		// if your underlying container supports deletions
 		bool remove(const K &key) {
-			size_t index = getHashedIndex(key);
-			return hashmap[index].remove(TypedEntry(key));
+			size_t keyHash = hash(key);
+			if (!mayContain(keyHash))
+				return false;
+			return countRemove(hashmap[getIndex(keyHash)].remove(KeyProbe<K>{key}, keyHash));
+		}
+
+		template<class Q, class H = F, class = typename H::is_transparent>
+		bool remove(const Q &key) {
+			size_t keyHash = hash(key);
+			if (!mayContain(keyHash))
+				return false;
+			return countRemove(hashmap[getIndex(keyHash)].remove(KeyProbe<Q>{key}, keyHash));
+		}
+
+		/*
+		 * Hand every key and value to fn, one bucket at a time, in place.
+		 * Entries added or removed meanwhile may or may not be seen, but
+		 * none is seen twice. Writers are never blocked by lock free
+		 * buckets. Fn must not hold on to the references or call back
+		 * into the map.
+		 */
+		template<class Fn>
+		void forEach(Fn &&fn) {
+			for (Bucket &bucket : hashmap) {
+				bucket.forEach([&fn](const TypedEntry &entry) {
+					entry.val.read([&](const V &val) { fn(entry.key, val); });
+				});
+			}
+		}
+
+		/*
+		 * Same as forEach, with buckets split across threads, the caller
+		 * being one of them. Chunks of buckets are handed out as threads
+		 * free up, so a few long chains don't hold the rest back.
+		 * Fn runs on many threads at once.
+		 */
+		template<class Fn>
+		void parallelForEach(Fn &&fn, uint threads = parallel::defaultThreads()) {
+			parallel::forEachChunk(hashmap.size(), threads, [&](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++) {
+					hashmap[i].forEach([&fn](const TypedEntry &entry) {
+						entry.val.read([&](const V &val) { fn(entry.key, val); });
+					});
+				}
+			});
+		}
+
+		/*
+		 * Fold map(key, val) of every entry into init with combine, buckets
+		 * split across threads like parallelForEach. Each chunk is folded
+		 * on its own and then combined into the total, in no set order, so
+		 * combine must be associative and commutative.
+		 */
+		template<class R, class Map, class Combine>
+		R parallelReduce(R init, Map &&map, Combine &&combine, uint threads = parallel::defaultThreads()) {
+			std::mutex totalMtx;
+			parallel::forEachChunk(hashmap.size(), threads, [&](size_t begin, size_t end) {
+				std::optional<R> partial;
+				for (size_t i = begin; i < end; i++) {
+					hashmap[i].forEach([&](const TypedEntry &entry) {
+						entry.val.read([&](const V &val) {
+							R mapped = map(entry.key, val);
+							if (partial)
+								partial = combine(std::move(*partial), std::move(mapped));
+							else
+								partial = std::move(mapped);
+						});
+					});
+				}
+				if (partial) {
+					std::lock_guard<std::mutex> lock(totalMtx);
+					init = combine(std::move(init), std::move(*partial));
+				}
+			});
+			return init;
+		}
+
+		/*
+		 * Iterate over copies of every entry, safe alongside puts and
+		 * removes. Each bucket is copied out as the iterator gets to it,
+		 * so what's seen is only as consistent as forEach, and an
+		 * iterator never points into the map itself.
+		 */
+		Iterator begin() { return Iterator(hashmap.data(), hashmap.size(), 0); }
+		Iterator end() { return Iterator(hashmap.data(), hashmap.size(), hashmap.size()); }
+
+		/*
+		 * How the buckets are loaded: chain lengths, load factor and an
+		 * estimate of the memory the map takes, see ll::BucketStats.
+		 * Buckets are split across threads and only their counts are
+		 * read, so this is fine to call on a large map in use.
+		 */
+		ll::BucketStats stats(uint threads = parallel::defaultThreads()) {
+			ll::BucketStats result = ll::bucketStats(hashmap.data(), hashmap.size(), threads);
+			if (filter)
+				result.filterBytes = filter->bytes();
+			return result;
+		}
+
+		/*
+		 * Number of entries, read off a counter sharded across threads
+		 * so puts and removes don't all bump one cache line. Exact below
+		 * 512 entries per shard. Above that it's one load, and once
+		 * puts and removes settle it's off by less than 32 per shard, which
+		 * is under a fifteenth of the count.
+		 */
+		size_t size() const {
+			long count = entries.estimate();
+			return count < 0 ? 0 : count;
+		}
+
+		// Number of entries, counting every one of the puts and removes that
+		// finished before the call. Reads each shard, never the buckets
+		size_t exactSize() const {
+			long count = entries.exact();
+			return count < 0 ? 0 : count;
+		}
+
+		/*
+		 * Look up count keys at once, out[i] gets the result for keys[i].
+		 * Keys are hashed and their buckets prefetched a chunk at a time,
+		 * so the cache misses of a chunk overlap instead of queueing up.
+		 */
+		void getMany(const K *keys, size_t count, std::pair<bool, V> *out) {
+			size_t hashes[PREFETCH_BATCH], indices[PREFETCH_BATCH];
+
+			for (size_t done = 0; done < count;) {
+				size_t chunk = prefetchChunk(keys + done, count - done, hashes, indices);
+
+				for (size_t i = 0; i < chunk; i++)
+					out[done + i] = getWithHash(keys[done + i], hashes[i]);
+				done += chunk;
+			}
+		}
+
+		std::vector<std::pair<bool, V>> getMany(const std::vector<K> &keys) {
+			std::vector<std::pair<bool, V>> out(keys.size());
+			getMany(keys.data(), keys.size(), out.data());
+			return out;
+		}
+
+		// Associate keys[i] with vals[i] for count pairs, prefetched like getMany
+		void putMany(const K *keys, const V *vals, size_t count) {
+			size_t hashes[PREFETCH_BATCH], indices[PREFETCH_BATCH];
+
+			for (size_t done = 0; done < count;) {
+				size_t chunk = prefetchChunk(keys + done, count - done, hashes, indices);
+
+				for (size_t i = 0; i < chunk; i++)
+					countAdd(bucketForAdd(hashes[i]).add(TypedEntry(keys[done + i], vals[done + i]), hashes[i]));
+				done += chunk;
+			}
+		}
+
+		void putMany(const std::vector<K> &keys, const std::vector<V> &vals) {
+			assert(keys.size() == vals.size());
+			putMany(keys.data(), vals.data(), keys.size());
 		}
 	};
 
 	/* Hashmap with managed threads
 	 *
-	 * We will allow the user to queue up
-	 * as they would like to, but upon context switching from
-	 * 'put's to 'get's, we require that all actions of the previous
-	 * context fully finish execution.
+	 * Puts and gets are pushed onto one lock free queue and served by
+	 * a fixed pool of long lived worker threads, which drain the queue
+	 * in batches. A get observes every put queued before it, and its
+	 * result is handed back through a future or a callback, so the
+	 * caller never has to wait on the workers itself.
 	 */
 	template<
 		class K,
@@ -109,64 +560,174 @@ namespace tshm {
 		// Less typing later
 		typedef Entry<K, V> TypedEntry;
 
+	public:
+		// Called on a worker thread with the status of containment and value
+		typedef std::function<void(bool, const V &)> Callback;
+
 	private:
+		// Most jobs a worker takes off the queue at once
+		static const size_t BATCH = 32;
+
+		// Progress of a worker that isn't holding any jobs
+		static const size_t IDLE = SIZE_MAX;
+
+		// Queued operation
+		struct Job {
+			TypedEntry entry;
+			Callback callback; // Empty for puts
+		};
+
+		/*
+		 * Queue position a worker has finished everything before,
+		 * out of the jobs it popped. Padded so workers don't share lines.
+		 */
+		struct alignas(64) Progress {
+			std::atomic<size_t> position;
+		};
+
 		// Private member variables
 		uint capacity;
 		F hash;
 		std::vector<Container<TypedEntry>> hashmap;
 
-		// We will using a counting semaphore to limit our job count
-		semaphore::CountingSemaphore threadLock;
+		// Queued jobs and the workers that serve them
+		queue::MPMCQueue<Job> jobs;
+		std::vector<std::thread> workers;
+		std::unique_ptr<Progress[]> progress;
+
+		// Idle workers sleep here until a job shows up
+		std::mutex sleepMtx;
+		std::condition_variable wake;
+		std::atomic<uint> sleepers;
+		std::atomic<bool> stopping;
+
+		// Wrapper method to extract index from a key's hash
+		size_t getIndex(size_t keyHash) const {
+			return keyHash % capacity;
+		}
+
+		// Wait until no other worker holds a put queued before position
+		void waitForPutsBefore(uint self, size_t position) {
+			for (uint other = 0; other < workers.size(); other++) {
+				if (other == self)
+					continue;
+				while (progress[other].position.load(std::memory_order_acquire) < position)
+					std::this_thread::yield();
+			}
+		}
+
+		// Worker loop, serve batches until we're told to stop
+		void work(uint self) {
+			std::vector<Job> batch(BATCH);
+			std::atomic<size_t> &position = progress[self].position;
+
+			while (true) {
+				// Anything we pop sits at or after this, so publish it
+				// before popping for gets that are waiting on us
+				position.store(jobs.nextPopPosition());
+				size_t first;
+				size_t count = jobs.tryPopBatch(batch.data(), BATCH, &first);
 
-		// Wrapper method to extract index from key
-		size_t getHashedIndex(const K &key) const {
-			return hash(key) % capacity;
+				if (count == 0) {
+					position.store(IDLE, std::memory_order_release);
+
+					std::unique_lock<std::mutex> lock(sleepMtx);
+					sleepers++;
+					wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+					sleepers--;
+
+					if (stopping && jobs.empty())
+						return;
+					continue;
+				}
+
+				for (size_t i = 0; i < count; i++) {
+					position.store(first + i, std::memory_order_release);
+					Job &job = batch[i];
+					size_t keyHash = hash(job.entry.key);
+					size_t index = getIndex(keyHash);
+
+					if (!job.callback) {
+						hashmap[index].add(job.entry, keyHash);
+						continue;
+					}
+
+					// Earlier puts might still be in another worker's batch
+					waitForPutsBefore(self, first + i);
+					bool contained = hashmap[index].find(job.entry, keyHash);
+					job.callback(contained, contained ? job.entry.val.load() : V{});
+					job.callback = nullptr;
+				}
+			}
+		}
+
+		// Queue up a job and wake a worker for it
+		void submit(Job &&job) {
+			// Queue is full, let the workers catch up
+			while (!jobs.tryPush(std::move(job)))
+				std::this_thread::yield();
+
+			// Only pay for a wake up if someone is asleep.
+			// The fence pairs with the sleeper's increment so one of us
+			// always sees the other
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (sleepers.load()) {
+				std::lock_guard<std::mutex> lock(sleepMtx);
+				wake.notify_one();
+			}
 		}
 
 	public:
 		// Construct a new managed hashmap
-		ManagedHashmap(uint capacity, uint maxWorkerThreads = 4)
-			: capacity(capacity), hashmap(capacity),
-			threadLock(maxWorkerThreads) {}
+		ManagedHashmap(uint capacity, uint maxWorkerThreads = 4, size_t queueCapacity = 1 << 14)
+			: capacity(capacity), hashmap(capacity), jobs(queueCapacity),
+			progress(new Progress[maxWorkerThreads]), sleepers(0), stopping(false) {
+			for (uint i = 0; i < maxWorkerThreads; i++)
+				progress[i].position.store(IDLE);
+			for (uint i = 0; i < maxWorkerThreads; i++)
+				workers.emplace_back(&ManagedHashmap::work, this, i);
+		}
 
-		// On destruct, wait for all operations to finish
-		virtual ~ManagedHashmap() { while (threadLock.active); }
+		// On destruct, finish every queued job and stop the workers
+		virtual ~ManagedHashmap() {
+			{
+				std::lock_guard<std::mutex> lock(sleepMtx);
+				stopping = true;
+			}
+			wake.notify_all();
+
+			for (std::thread &worker : workers)
+				worker.join();
+		}
 
 		// Associate specified key with specified value
 		void put(const K &key, const V &val) {
-			// Acquire the thread semaphore
-			threadLock.acquire();
-
-			// Spawn new thread
-			std::thread t([&] (TypedEntry entry) {
-				size_t index = getHashedIndex(entry.key);
-				hashmap[index].add(entry);
-				threadLock.release();
-			}, TypedEntry(key, val));
-
-			// Detach the thread
-			t.detach();
+			submit(Job{ TypedEntry(key, val), nullptr });
 		}
 
 		/*
-		* Get the pointer to the value associated with a key.
-		* Note that this is sequential for now, as it doesn't make much
-		* sense for a managed object to be fully async. We would need to implement
-		* promises, which might happen at a later date.
-
-		* TODO: Implement promises
-		*/
-		std::pair<bool, V> get(const K &key) {
-			// Spin until all puts are done
-			while (threadLock.active);
+		 * Look a key up once every put queued before this call has landed.
+		 * The callback runs on a worker thread, so keep it short, and it
+		 * must not throw or call back into this hashmap.
+		 */
+		void getAsync(const K &key, Callback callback) {
+			assert(callback);
+			submit(Job{ TypedEntry(key), std::move(callback) });
+		}
 
-			// Get item
-			size_t index = getHashedIndex(key);
-			TypedEntry entry(key);
-			if (hashmap[index].find(entry))
-				return {true, entry.val};
+		// Same as above, but hand the result back through a future
+		std::future<std::pair<bool, V>> getAsync(const K &key) {
+			auto promise = std::make_shared<std::promise<std::pair<bool, V>>>();
+			std::future<std::pair<bool, V>> result = promise->get_future();
+			getAsync(key, [promise](bool contained, const V &val) {
+				promise->set_value({contained, val});
+			});
+			return result;
+		}
 
-			return {false, V{}};
+		// Return the status of containment and value, blocks until served
+		std::pair<bool, V> get(const K &key) {
+			return getAsync(key).get();
 		}
 	};
 };
@@ -1,12 +1,23 @@
+#pragma once
+
 #include <vector>
+#include <memory>
+#include <algorithm>
+#include <utility>
+#include <optional>
+#include <mutex>
 #include "LinkedList.h"
+#include "Parallel.h"
+#include "ShardedCounter.h"
+#include "BloomFilter.h"
+#include "StringHash.h"
 
 // Hashset abstract
 template<class T>
 class IHashset {
 public:
-	virtual void insert(const T &item) = 0;
-	virtual bool contains(T item) = 0;
+	virtual bool insert(const T &item) = 0;
+	virtual bool contains(const T &item) = 0;
 };
 
 // Thread safe hashset
@@ -28,29 +39,315 @@ namespace tshs {
 		uint capacity;
 		F hash;
 		std::vector<Container<T>> hashset;
+		std::unique_ptr<bloom::BlockedBloomFilter> filter; // Null unless asked for
+		counter::ShardedCounter items;
+
+		// Items a batched call hashes and prefetches at once
+		static constexpr size_t PREFETCH_BATCH = 16;
+
+		// Wrapper method to extract index from an item's hash
+		size_t getIndex(size_t itemHash) const {
+			return itemHash % capacity;
+		}
+
+		// Bucket for an item we may add, noted in the filter before it can land
+		Container<T> &bucketForAdd(size_t itemHash) {
+			if (filter)
+				filter->insert(itemHash);
+			return hashset[getIndex(itemHash)];
+		}
+
+		// Keep the size in step with what a bucket did
+		bool countAdd(bool added) {
+			if (added)
+				items.increment();
+			return added;
+		}
+		bool countRemove(bool removed) {
+			if (removed)
+				items.decrement();
+			return removed;
+		}
+
+		// False only if the item is definitely not in the set
+		bool mayContain(size_t itemHash) const {
+			return !filter || filter->mayContain(itemHash);
+		}
+
+		// Hash a chunk of items and warm their buckets, return the chunk size
+		size_t prefetchChunk(const T *items, size_t count, size_t *hashes, size_t *indices) const {
+			count = std::min(count, PREFETCH_BATCH);
+			for (size_t i = 0; i < count; i++) {
+				hashes[i] = hash(items[i]);
+				indices[i] = getIndex(hashes[i]);
+			}
+			ll::prefetchBuckets(hashset.data(), indices, count);
+			return count;
+		}
+
+		// Items are copied as is by iterators
+		struct Copy {
+			const T &operator()(const T &item) const { return item; }
+		};
 
-		// Wrapper method to extract index from key
-		size_t getHashedIndex(const T &item) const {
-			return hash(item) % capacity;
+		// Copy each bucket out and hand its items to fn, buckets split across threads
+		template<class Fn>
+		void forEachBucketChunk(uint threads, Fn &&fn) {
+			parallel::forEachChunk(hashset.size(), threads, [&](size_t begin, size_t end) {
+				std::vector<T> items;
+				for (size_t i = begin; i < end; i++) {
+					items.clear();
+					hashset[i].forEach([&items](const T &item) { items.push_back(item); });
+					fn(items);
+				}
+			});
 		}
 
 	public:
-		// Construct hashmap
-		Hashset(uint capacity) : capacity(capacity), hashset(capacity) {}
+		// Weakly consistent iterator over item copies, see begin
+		typedef ll::SnapshotIterator<Container<T>, T, Copy> Iterator;
+
+		/*
+		 * Construct hashset. A non zero bloomBitsPerKey puts a bloom
+		 * filter sized for capacity items in front of the buckets, see
+		 * Hashmap.
+		 */
+		Hashset(uint capacity, uint bloomBitsPerKey = 0) : capacity(capacity), hashset(capacity) {
+			if (bloomBitsPerKey > 0)
+				filter.reset(new bloom::BlockedBloomFilter(capacity, bloomBitsPerKey));
+		}
 
 		// Nothing really interesting about the destructor
 		virtual ~Hashset() {}
 
-		// Associate specified key with specified value
-		void insert(const T &item) {
-			size_t index = getHashedIndex(item);
-			hashset[index].add(item);
+		// Add item, returns whether it was new
+		bool insert(const T &item) {
+			return insertWithHash(item, hash(item));
+		}
+
+		// Same as above, moving the item into the bucket
+		bool insert(T &&item) {
+			size_t itemHash = hash(item);
+			return countAdd(bucketForAdd(itemHash).tryEmplace(item, itemHash, std::move(item)));
+		}
+
+		/*
+		 * Build an item from args and move it into the bucket if it's missing.
+		 * Returns whether we added it.
+		 */
+		template<class... Args>
+		bool emplace(Args&&... args) {
+			T item(std::forward<Args>(args)...);
+			size_t itemHash = hash(item);
+			return countAdd(bucketForAdd(itemHash).tryEmplace(item, itemHash, std::move(item)));
 		}
 
 		// Returns whether the item is in the Hashset
-		bool contains(T item) {
-			size_t index = getHashedIndex(item);
-			return hashset[index].find(item);
+		bool contains(const T &item) {
+			return containsWithHash(item, hash(item));
+		}
+
+		/*
+		 * Heterogeneous lookup, for when F is transparent (F::is_transparent).
+		 * Q can be anything F hashes like a T and T compares equal to,
+		 * e.g. std::string_view with tshm::StringHash.
+		 */
+		template<class Q, class H = F, class = typename H::is_transparent>
+		bool contains(const Q &item) {
+			return containsWithHash(item, hash(item));
+		}
+
+		/*
+		 * Same as insert and contains, for callers that already hold the
+		 * item's hash. itemHash must be exactly what F gives for item.
+		 * Items already here are left alone, readers may be comparing them.
+		 */
+		bool insertWithHash(const T &item, size_t itemHash) {
+			return countAdd(bucketForAdd(itemHash).tryEmplace(item, itemHash, item));
+		}
+
+		template<class Q = T>
+		bool containsWithHash(const Q &item, size_t itemHash) {
+			if (!mayContain(itemHash))
+				return false;
+			return hashset[getIndex(itemHash)].visit(item, itemHash, [](const T &) {});
+		}
+
+		// Remove item, returns whether it was there. Only works
+		// if your underlying container supports deletions
+		bool erase(const T &item) {
+			size_t itemHash = hash(item);
+			if (!mayContain(itemHash))
+				return false;
+			return countRemove(hashset[getIndex(itemHash)].remove(item, itemHash));
+		}
+
+		template<class Q, class H = F, class = typename H::is_transparent>
+		bool erase(const Q &item) {
+			size_t itemHash = hash(item);
+			if (!mayContain(itemHash))
+				return false;
+			return countRemove(hashset[getIndex(itemHash)].remove(item, itemHash));
+		}
+
+		/*
+		 * Hand every item to fn, one bucket at a time. Items added or
+		 * removed meanwhile may or may not be seen, but none is seen
+		 * twice. Fn must not call back into the set.
+		 */
+		template<class Fn>
+		void forEach(Fn &&fn) {
+			for (Container<T> &bucket : hashset)
+				bucket.forEach(fn);
+		}
+
+		/*
+		 * Same as forEach, with buckets split across threads, see
+		 * Hashmap::parallelForEach. Fn runs on many threads at once.
+		 */
+		template<class Fn>
+		void parallelForEach(Fn &&fn, uint threads = parallel::defaultThreads()) {
+			parallel::forEachChunk(hashset.size(), threads, [&](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++)
+					hashset[i].forEach(fn);
+			});
+		}
+
+		/*
+		 * Fold map(item) of every item into init with combine, see
+		 * Hashmap::parallelReduce. Combine must be associative and
+		 * commutative.
+		 */
+		template<class R, class Map, class Combine>
+		R parallelReduce(R init, Map &&map, Combine &&combine, uint threads = parallel::defaultThreads()) {
+			std::mutex totalMtx;
+			parallel::forEachChunk(hashset.size(), threads, [&](size_t begin, size_t end) {
+				std::optional<R> partial;
+				for (size_t i = begin; i < end; i++) {
+					hashset[i].forEach([&](const T &item) {
+						R mapped = map(item);
+						if (partial)
+							partial = combine(std::move(*partial), std::move(mapped));
+						else
+							partial = std::move(mapped);
+					});
+				}
+				if (partial) {
+					std::lock_guard<std::mutex> lock(totalMtx);
+					init = combine(std::move(init), std::move(*partial));
+				}
+			});
+			return init;
+		}
+
+		/*
+		 * Iterate over copies of every item, safe alongside inserts and
+		 * erases. Buckets are copied out as the iterator gets to them,
+		 * see forEach for what's seen.
+		 */
+		Iterator begin() { return Iterator(hashset.data(), hashset.size(), 0); }
+		Iterator end() { return Iterator(hashset.data(), hashset.size(), hashset.size()); }
+
+		/*
+		 * How the buckets are loaded: chain lengths, load factor and an
+		 * estimate of the memory the set takes, see ll::BucketStats.
+		 * Buckets are split across threads and only their counts are
+		 * read, so this is fine to call on a large set in use.
+		 */
+		ll::BucketStats stats(uint threads = parallel::defaultThreads()) {
+			ll::BucketStats result = ll::bucketStats(hashset.data(), hashset.size(), threads);
+			if (filter)
+				result.filterBytes = filter->bytes();
+			return result;
+		}
+
+		/*
+		 * Number of items, read off a counter sharded across threads
+		 * so inserts and erases don't all bump one cache line. Exact below
+		 * 512 items per shard. Above that it's one load, and once
+		 * inserts and erases settle it's off by less than 32 per shard, which
+		 * is under a fifteenth of the count.
+		 */
+		size_t size() const {
+			long count = items.estimate();
+			return count < 0 ? 0 : count;
+		}
+
+		// Number of items, counting every one of the inserts and erases that
+		// finished before the call. Reads each shard, never the buckets
+		size_t exactSize() const {
+			long count = items.exact();
+			return count < 0 ? 0 : count;
+		}
+
+		/*
+		 * Set algebra in place, buckets are split across threads.
+		 * Each bucket is copied out before it's acted on, so other can be
+		 * this set, and both may be used concurrently, though then the
+		 * result only reflects whatever each bucket held when it was read.
+		 * Intersect and difference erase, see erase.
+		 */
+
+		// Add everything in other
+		void unionWith(Hashset &other, uint threads = parallel::defaultThreads()) {
+			other.forEachBucketChunk(threads, [this](std::vector<T> &items) {
+				for (T &item : items)
+					insert(std::move(item));
+			});
+		}
+
+		// Keep only what's also in other
+		void intersect(Hashset &other, uint threads = parallel::defaultThreads()) {
+			forEachBucketChunk(threads, [this, &other](std::vector<T> &items) {
+				for (const T &item : items)
+					if (!other.contains(item))
+						erase(item);
+			});
+		}
+
+		// Drop everything that's in other
+		void difference(Hashset &other, uint threads = parallel::defaultThreads()) {
+			forEachBucketChunk(threads, [this, &other](std::vector<T> &items) {
+				for (const T &item : items)
+					if (other.contains(item))
+						erase(item);
+			});
+		}
+
+		// Insert count items at once, buckets are prefetched a chunk at a time
+		void insertMany(const T *items, size_t count) {
+			size_t hashes[PREFETCH_BATCH], indices[PREFETCH_BATCH];
+
+			for (size_t done = 0; done < count;) {
+				size_t chunk = prefetchChunk(items + done, count - done, hashes, indices);
+
+				for (size_t i = 0; i < chunk; i++)
+					countAdd(bucketForAdd(hashes[i]).tryEmplace(items[done + i], hashes[i], items[done + i]));
+				done += chunk;
+			}
+		}
+
+		void insertMany(const std::vector<T> &items) {
+			insertMany(items.data(), items.size());
+		}
+
+		// Check count items at once, out[i] says whether items[i] is in the set
+		void containsMany(const T *items, size_t count, bool *out) {
+			size_t hashes[PREFETCH_BATCH], indices[PREFETCH_BATCH];
+
+			for (size_t done = 0; done < count;) {
+				size_t chunk = prefetchChunk(items + done, count - done, hashes, indices);
+
+				for (size_t i = 0; i < chunk; i++)
+					out[done + i] = containsWithHash(items[done + i], hashes[i]);
+				done += chunk;
+			}
+		}
+
+		std::vector<bool> containsMany(const std::vector<T> &items) {
+			std::unique_ptr<bool[]> found(new bool[items.size()]);
+			containsMany(items.data(), items.size(), found.get());
+			return std::vector<bool>(found.get(), found.get() + items.size());
 		}
 	};
 };
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <vector>
+#include <array>
+#include <memory>
+#include <string>
+#include <fstream>
+#include <cstdint>
+
+// Optional counters for contention on the hot paths
+namespace instrument {
+
+	// What gets counted
+	enum Event {
+		LL_ADD_CAS_FAILURE,       // LockFreeLL lost a race linking a node
+		LL_REMOVE_CAS_FAILURE,    // LockFreeLL lost a race marking or unlinking a node
+		LL_FIND_RETRY,            // LockFreeLL::_find started over from the head
+		ADD_ONLY_CAS_FAILURE,     // AddOnlyLockFreeLL lost a race linking a node
+		EXCHANGE_REF_CAS_FAILURE, // MarkableReference::exchangeRef looped
+		LOCK_WAITS,               // LockableLL found a node lock taken
+		LOCK_WAIT_NANOS,          // and how long it waited for it
+		SEMAPHORE_WAITS,          // CountingSemaphore::acquire had to sleep
+		SEMAPHORE_WAIT_NANOS,     // and how long it slept
+		EVENT_COUNT
+	};
+
+	// Column names for dumps
+	inline const char *eventName(Event event) {
+		static const char *NAMES[EVENT_COUNT] = {
+			"ll_add_cas_failure",
+			"ll_remove_cas_failure",
+			"ll_find_retry",
+			"add_only_cas_failure",
+			"exchange_ref_cas_failure",
+			"lock_waits",
+			"lock_wait_nanos",
+			"semaphore_waits",
+			"semaphore_wait_nanos"
+		};
+		return NAMES[event];
+	}
+
+	/*
+	 * Instrumentation policies, passed as a template parameter.
+	 * Each has enabled, and count(event, amount) for the hot paths to call.
+	 */
+
+	// Counts nothing, every call compiles away. The default
+	struct Disabled {
+		static constexpr bool enabled = false;
+		static void count(Event, uint64_t = 1) {}
+	};
+
+	/* Counts into a block per thread
+	 *
+	 * Only its own thread writes a block, so counting is a plain load
+	 * and store on a line nobody else touches. Blocks outlive their
+	 * threads, so counts can be read once the work is done.
+	 * Reads while threads count are racy but never torn.
+	 * Shared by everything instrumented with it.
+	 */
+	class Counters {
+	public:
+		typedef std::array<uint64_t, EVENT_COUNT> Totals;
+
+		static constexpr bool enabled = true;
+
+		static void count(Event event, uint64_t amount = 1) {
+			std::atomic<uint64_t> &slot = local().counts[event];
+			slot.store(slot.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+		}
+
+		// Counts of every thread that counted anything, in the order they started
+		static std::vector<Totals> perThread() {
+			Registry &reg = registry();
+			std::lock_guard<std::mutex> lock(reg.mtx);
+
+			std::vector<Totals> result;
+			for (const std::unique_ptr<Block> &block : reg.blocks) {
+				Totals totals;
+				for (int event = 0; event < EVENT_COUNT; event++)
+					totals[event] = block->counts[event].load(std::memory_order_relaxed);
+				result.push_back(totals);
+			}
+			return result;
+		}
+
+		// Counts summed over every thread
+		static Totals totals() {
+			Totals sum{};
+			for (const Totals &thread : perThread())
+				for (int event = 0; event < EVENT_COUNT; event++)
+					sum[event] += thread[event];
+			return sum;
+		}
+
+		// Zero everything, only while nothing is counting
+		static void reset() {
+			Registry &reg = registry();
+			std::lock_guard<std::mutex> lock(reg.mtx);
+			for (const std::unique_ptr<Block> &block : reg.blocks)
+				for (int event = 0; event < EVENT_COUNT; event++)
+					block->counts[event].store(0, std::memory_order_relaxed);
+		}
+
+		// Write thread,event,count rows, returns whether the file opened
+		static bool dumpCsv(const std::string &path = "analysis/data/instrumentation.csv") {
+			std::ofstream res(path);
+			if (!res)
+				return false;
+
+			std::vector<Totals> threads = perThread();
+			res << "thread,event,count\n";
+			for (size_t thread = 0; thread < threads.size(); thread++) {
+				for (int event = 0; event < EVENT_COUNT; event++) {
+					res <<
+						thread << "," <<
+						eventName((Event)event) << "," <<
+						threads[thread][event] << "\n";
+				}
+			}
+			return true;
+		}
+
+	private:
+		struct alignas(64) Block {
+			std::atomic<uint64_t> counts[EVENT_COUNT];
+
+			Block() {
+				for (int event = 0; event < EVENT_COUNT; event++)
+					counts[event].store(0, std::memory_order_relaxed);
+			}
+		};
+
+		// Every block handed out, freed at exit
+		struct Registry {
+			std::mutex mtx;
+			std::vector<std::unique_ptr<Block>> blocks;
+		};
+
+		static Registry &registry() {
+			static Registry reg;
+			return reg;
+		}
+
+		// Calling thread's block, made on its first count
+		static Block &local() {
+			static thread_local Block *mine = nullptr;
+			if (mine == nullptr) {
+				Registry &reg = registry();
+				std::lock_guard<std::mutex> lock(reg.mtx);
+				reg.blocks.emplace_back(new Block());
+				mine = reg.blocks.back().get();
+			}
+			return *mine;
+		}
+	};
+
+	// Nanoseconds since some fixed point, for timing waits
+	inline uint64_t nanos() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()
+		).count();
+	}
+
+	// Lock mtx, counting and timing the wait if someone else holds it.
+	// Just locks when Instrument is disabled
+	template<class Instrument, class Mutex>
+	void lock(Mutex &mtx) {
+		if constexpr (Instrument::enabled) {
+			if (mtx.try_lock())
+				return;
+			Instrument::count(LOCK_WAITS);
+			uint64_t start = nanos();
+			mtx.lock();
+			Instrument::count(LOCK_WAIT_NANOS, nanos() - start);
+		} else {
+			mtx.lock();
+		}
+	}
+};
@@ -1,16 +1,29 @@
+#pragma once
+
 #include <iostream>
 #include <cstddef>
 #include <mutex>
 #include <atomic>
+#include <tuple>
+#include <utility>
+#include <functional>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <unordered_set>
 #include <assert.h>
 #include "MarkableReference.h"
+#include "Reclamation.h"
+#include "NodePool.h"
+#include "Parallel.h"
+#include "Instrumentation.h"
 
 // Linked list abstract
 template<class T>
 class ILinkedList {
 public:
-	// Add an element to the list
-	virtual void add(const T &val) = 0;
+	// Add an element to the list, returns whether it was new
+	virtual bool add(const T &val) = 0;
 
 	// Find an element, return containment
 	// Stores found element in val
@@ -19,222 +32,342 @@ public:
 
 namespace ll {
 
-	// Full support lock free ll
+	/*
+	 * Hash of a list value, cached in the nodes and used to order
+	 * sorted lists. Found by ADL, so element types can supply their own.
+	 */
+	template<class T>
+	size_t hashOf(const T &val) {
+		return std::hash<T>()(val);
+	}
+
+	/*
+	 * Overwrite a value an add found with the one it was given.
+	 * Found by ADL, so element types can update just part of themselves.
+	 */
 	template<class T>
+	void assignValue(T &dst, const T &src) {
+		dst = src;
+	}
+
+	template<class T>
+	void assignValue(T &dst, T &&src) {
+		dst = std::move(src);
+	}
+
+	/* Full support lock free ll
+	 *
+	 * Removed nodes are handed to the Reclaimer policy,
+	 * which frees them once no traversal can still reach them.
+	 * Nodes come from the Alloc policy.
+	 *
+	 * Sorted lists keep nodes in hash order (Harris-Michael),
+	 * so a lookup stops as soon as it passes where the value would be.
+	 * Unsorted lists append at the tail and scan to the end on a miss.
+	 * Instrument counts lost CAS races and retries, see Instrumentation.h.
+	 */
+	template<
+		class T,
+		class Reclaimer = reclaim::EpochBased,
+		class Alloc = alloc::HeapAllocator,
+		bool Sorted = false,
+		class Instrument = instrument::Disabled
+	>
 	class LockFreeLL : ILinkedList<T> {
+	public:
+		// Same list, different node allocator
+		template<class A>
+		using WithAllocator = LockFreeLL<T, Reclaimer, A, Sorted, Instrument>;
+
 	private:
-		std::mutex mtx;
+		typedef typename Reclaimer::Guard Guard;
 
 		// Regular Linked-List Node
 		class Node {
 		public:
-			MarkableReference<Node> next;
+			MarkableReference<Node, Instrument> next;
+			size_t hash = 0; // Cached so we compare it before the value
 			T val;
 			bool isCap;
 
-			// Keep track of how many people are watching this reference
-			std::atomic<int> watchers;
-
-			Node() : isCap(true), watchers(0) {} // Dummy node for head and tail
-			Node(T val) : val(val), isCap(false), watchers(0) {}
+			Node() : isCap(true) {} // Dummy node for head and tail
+			template<class... Args>
+			Node(size_t hash, Args&&... args)
+				: hash(hash), val(std::forward<Args>(args)...), isCap(false) {}
 		};
 
-		// Abstraction layer for lots of watches
-		Node *getAndWatch(Node *node) {
-			if (node != nullptr)
-				node->watchers++;
-			return node;
-		}
-		void stopWatching(Node *node) {
-			if (node != nullptr)
-				node->watchers--;
-		}
+		// Hazard slots used while traversing
+		static const int SUCC_SLOT = 0, CURR_SLOT = 1, PRED_SLOT = 2;
 
-		Node *head;
+		// Null until the first add, so empty lists cost no allocations
+		std::atomic<Node *> head;
 		std::atomic<size_t> curSize;
 
-	public:
-		// Construct with dummy head
-		LockFreeLL() : curSize(0) {
-			// Make head and tail, both caps
-			head = new Node();
-			head->next = MarkableReference<Node>(new Node());
+		// Current head, allocating the head and tail caps if there are none
+		Node *materialize() {
+			Node *curr = head.load(std::memory_order_acquire);
+			if (curr != nullptr)
+				return curr;
+
+			Node *fresh = Alloc::template create<Node>();
+			fresh->next = MarkableReference<Node, Instrument>(Alloc::template create<Node>());
+			if (head.compare_exchange_strong(curr, fresh, std::memory_order_acq_rel))
+				return fresh;
+
+			// Somebody beat us to it
+			Alloc::destroy(fresh->next.getRef());
+			Alloc::destroy(fresh);
+			return curr;
 		}
 
-		// Destruct, free all nodes
-		virtual ~LockFreeLL() {
-			Node *curr = head;
-			while (curr != nullptr) {
-				Node *next = curr->next.getRef();
-				delete curr;
-				curr = next;
-			}
+		// Hand an unlinked node to the reclaimer
+		static void retire(Node *node) {
+			Reclaimer::retire(node, [](void *ptr) {
+				Alloc::destroy(static_cast<Node *>(ptr));
+			});
 		}
 
-		// Returns the head. Not thread safe.
-		Node *NOT_THREAD_SAFE_getHead() { return head; }
-
-		void safeDelete(Node *toDelete) {
-			while (toDelete->watchers > 0);
-			delete toDelete;
-		}
-
-		// Find a value, internal use
-		// Note that we do not stop watching returned nodes
-		// This *must* be cleaned up by the callee
-		std::pair<Node *, Node *> _find(const T &val) {
+		/*
+		 * Find a value, internal use.
+		 * Returns the window the value belongs in and whether it's there:
+		 * the matching node, or the node to insert before, and its
+		 * predecessor, both protected by the caller's guard.
+		 * Marked nodes we pass over are unlinked and retired.
+		 * Probe is anything a T compares equal to with ==.
+		 */
+		template<class Probe>
+		std::tuple<Node *, Node *, bool> _find(Node *head, const Probe &val, size_t hash, Guard &guard) {
 			Node *pred, *curr, *succ;
-			bool marked;
+			bool marked, predMarked;
 
 			// Allow ourselves to jump back and retry
 retry:;
 
 			// Head is guaranteed to exist, dummy node
-			pred = getAndWatch(head);
-			curr = getAndWatch(pred->next.getRef());
+			pred = head;
+			curr = pred->next.getRef();
+			guard.protect(CURR_SLOT, curr);
+			if (pred->next.getRef() != curr) {
+				Instrument::count(instrument::LL_FIND_RETRY);
+				goto retry;
+			}
 
 			// While we have yet to reach the end of the list
-			while (true) {
-				succ = getAndWatch(curr->next.getBoth(marked));
+			while (!curr->isCap) {
+				succ = curr->next.getBoth(marked);
+				guard.protect(SUCC_SLOT, succ);
+
+				// Make sure succ was still linked from a live curr
+				// when we protected it, otherwise it may be freed
+				if (curr->next.getRef() != succ ||
+					pred->next.getBoth(predMarked) != curr || predMarked) {
+					Instrument::count(instrument::LL_FIND_RETRY);
+					goto retry;
+				}
 
-				while (marked) {
+				if (marked) {
 					// Try to physically delete the logically deleted node
 					Node *expectedRef = curr;
 					bool expectedMark = false;
-					Node *requiredRef = succ;
-					bool requiredMark = false;
 
 					if (!(pred->next.compareExchangeBothWeak(
 						expectedRef,
 						expectedMark,
-						requiredRef,
-						requiredMark
+						succ,
+						false
 					))) {
-						stopWatching(pred);
-						stopWatching(curr);
-						stopWatching(succ);
+						Instrument::count(instrument::LL_FIND_RETRY);
 						goto retry;
 					}
 
-					// Move and free mem
-					Node *toDelete = curr;
+					retire(curr);
+				} else {
+					// Passed where it would be, it's not here
+					if (Sorted && curr->hash > hash)
+						return { pred, curr, false };
 
-					curr = succ;
-					succ = getAndWatch(curr->next.getBoth(marked));
-
-					stopWatching(toDelete);
-					safeDelete(toDelete);
-				}
+					// If we found it, return
+					if (curr->hash == hash && curr->val == val)
+						return { pred, curr, true };
 
-				// If we found it, return
-				if (curr->isCap || curr->val == val) {
-					stopWatching(succ);
-					return { pred, curr };
+					pred = curr;
+					guard.protect(PRED_SLOT, pred);
 				}
 
 				// Move
-				stopWatching(pred);
-				pred = curr;
 				curr = succ;
+				guard.protect(CURR_SLOT, curr);
 			}
+
+			return { pred, curr, false };
 		}
 
-		// Add item to list
-		void add(const T &val) {
-			while (true) {
-				// Find our val
-				auto [ pred, curr ] = _find(val);
+	public:
+		// Construct empty, caps are made on the first add
+		LockFreeLL() : head(nullptr), curSize(0) {}
 
-				// Item already exists (don't match with cap)
-				if (!curr->isCap && curr->val == val) {
-					stopWatching(pred);
-					stopWatching(curr);
-					return;
+		// Destruct, free all nodes
+		virtual ~LockFreeLL() {
+			Node *curr = head.load();
+			while (curr != nullptr) {
+				Node *next = curr->next.getRef();
+				Alloc::destroy(curr);
+				curr = next;
+			}
+		}
+
+		// Returns the head, null if nothing was ever added. Not thread safe.
+		Node *NOT_THREAD_SAFE_getHead() { return head; }
+
+		// Cache hints for batched lookups, see prefetchBuckets
+		void prefetchHead() const { __builtin_prefetch(head.load(std::memory_order_relaxed)); }
+		void prefetchFirst() const {
+			Node *first = head.load(std::memory_order_relaxed);
+			if (first != nullptr)
+				__builtin_prefetch(first->next.getRef(std::memory_order_relaxed));
+		}
+
+		/*
+		 * Every operation has an overload taking the value's hash, for
+		 * callers that already have one. A list must always be given
+		 * the same hash for the same value, the plain overloads use hashOf.
+		 */
+
+		// Add new element to the list, optionally with its hash
+		// Existing elements are overwritten through assignValue, returns
+		// whether we added a new one
+		bool add(const T &val) { return add(val, hashOf(val)); }
+		bool add(const T &val, size_t hash) {
+			return _upsert(val, hash, [&val](T &match, T *) { assignValue(match, val); }, val);
+		}
+		bool add(T &&val, size_t hash) {
+			return _upsert(val, hash, [&val](T &match, T *spare) {
+				assignValue(match, std::move(spare != nullptr ? *spare : val));
+			}, std::move(val));
+		}
+
+		/*
+		 * Build an item from args right inside a new node, unless something
+		 * matching probe is already here. Returns whether we added it.
+		 */
+		template<class Probe, class... Args>
+		bool tryEmplace(const Probe &probe, size_t hash, Args&&... args) {
+			return _upsert(probe, hash, [](T &, T *) {}, std::forward<Args>(args)...);
+		}
+
+		/*
+		 * Same as tryEmplace, but hand whatever matched probe to fn, which
+		 * may race other writers of the same item. Args are only used
+		 * when nothing matched, and fn only runs when something did.
+		 * Returns whether we added a new item.
+		 */
+		template<class Probe, class Fn, class... Args>
+		bool findOrEmplace(const Probe &probe, size_t hash, Fn &&fn, Args&&... args) {
+			return _upsert(probe, hash, [&fn](T &match, T *) { fn(match); }, std::forward<Args>(args)...);
+		}
+
+	private:
+		/*
+		 * Find probe, or link a node built from args if it's missing.
+		 * onFound(match, spare) gets the match, and our node's value if
+		 * we built one before losing a race to it. Returns whether we
+		 * linked a new node.
+		 */
+		template<class Probe, class OnFound, class... Args>
+		bool _upsert(const Probe &probe, size_t hash, OnFound &&onFound, Args&&... args) {
+			Guard guard;
+			Node *node = nullptr;
+			Node *first = materialize();
+
+			while (true) {
+				// Find our val, once built the node is the probe since
+				// args may have been moved into it
+				auto [ pred, curr, found ] = node == nullptr
+					? _find(first, probe, hash, guard)
+					: _find(first, node->val, hash, guard);
+
+				// Item already exists
+				if (found) {
+					onFound(curr->val, node != nullptr ? &node->val : nullptr);
+					if (node != nullptr)
+						Alloc::destroy(node);
+					return false;
 				}
 
-				// Can now guarantee that curr is the tail (which is a cap)
-				// Attempt to link it in with CAS
-				Node *node = new Node(val);
-				node->next = MarkableReference<Node>(curr);
+				// Curr is where we belong (the tail cap if unsorted)
+				// Attempt to link in before it with CAS
+				if (node == nullptr)
+					node = Alloc::template create<Node>(hash, std::forward<Args>(args)...);
+				node->next = MarkableReference<Node, Instrument>(curr);
 
 				Node *expectedRef = curr;
 				bool expectedMark = false;
-				Node *requiredRef = node;
-				bool requiredMark = false;
 
-				bool success = pred->next.compareExchangeBothWeak(
+				if (pred->next.compareExchangeBothWeak(
 					expectedRef,
 					expectedMark,
-					requiredRef,
-					requiredMark
-				);
-				stopWatching(pred);
-				stopWatching(curr);
-
-				if (success) {
+					node,
+					false
+				)) {
 					curSize++;
-					return;
+					return true;
 				}
+				Instrument::count(instrument::LL_ADD_CAS_FAILURE);
 			}
 		}
 
-		// Remove item from list
-		bool remove(const T &val) {
+	public:
+		// Remove item from list, or whatever matches a probe with its hash
+		bool remove(const T &val) { return remove(val, hashOf(val)); }
+		template<class Probe>
+		bool remove(const Probe &val, size_t hash) {
+			Node *first = head.load(std::memory_order_acquire);
+			if (first == nullptr)
+				return false;
+
+			Guard guard;
+
 			while (true) {
-				auto [ pred, curr ] = _find(val);
+				auto [ pred, curr, found ] = _find(first, val, hash, guard);
 
 				// We didn't find it, stop
-				if (curr->isCap || !(curr->val == val)) {
-					stopWatching(pred);
-					stopWatching(curr);
+				if (!found)
 					return false;
-				}
 
 				// Logically delete node by marking it's successor
 				Node *succ = curr->next.getRef();
 
 				Node *expectedRef = succ;
 				bool expectedMark = false;
-				Node *requiredRef = succ;
-				bool requiredMark = true;
 
 				// Logical deletion, might need to retry
 				if (!(curr->next.compareExchangeBothWeak(
 					expectedRef,
 					expectedMark,
-					requiredRef,
-					requiredMark
+					succ,
+					true
 				))) {
-					stopWatching(pred);
-					stopWatching(curr);
+					Instrument::count(instrument::LL_REMOVE_CAS_FAILURE);
 					continue;
 				}
 
-				// It worked, attempt physical!
-				Node *toDelete = curr;
+				curSize--;
 
+				// It worked, attempt physical!
+				// If it doesn't work immediately, don't worry about it
+				// _find will clean
 				expectedRef = curr;
 				expectedMark = false;
-				requiredRef = succ;
-				requiredMark = false;
 
-				// If cut was successful, free mem
-				// If it doesn't work immediately, don't worry about it
-				// _find will clean
-				bool wasCut = pred->next.compareExchangeBothWeak(
+				if (pred->next.compareExchangeBothWeak(
 					expectedRef,
 					expectedMark,
-					requiredRef,
-					requiredMark
-				);
-				curSize--;
-
-				stopWatching(pred);
-				stopWatching(curr);
-
-				// Free ourselves
-				if (wasCut)
-					safeDelete(toDelete);
+					succ,
+					false
+				))
+					retire(curr);
+				else
+					Instrument::count(instrument::LL_REMOVE_CAS_FAILURE);
 
 				return true;
 			}
@@ -242,107 +375,364 @@ retry:;
 
 		// Returns true if the item is in the list,
 		// parameter updated
-		bool find(T &val) {
-			auto [ pred, curr ] = _find(val);
+		bool find(T &val) { return find(val, hashOf(val)); }
+		bool find(T &val, size_t hash) {
+			return visit(val, hash, [&val](const T &found) { val = found; });
+		}
+
+		/*
+		 * Find whatever matches a probe and hand it to fn, without copying.
+		 * The node is kept alive until fn returns, but may be removed
+		 * concurrently. Returns whether anything matched.
+		 */
+		template<class Probe, class Fn>
+		bool visit(const Probe &probe, size_t hash, Fn &&fn) {
+			return modify(probe, hash, [&fn](T &found) { fn(static_cast<const T &>(found)); });
+		}
+
+		/*
+		 * Same as visit, but fn gets to change what it finds, racing other
+		 * writers of it. Whatever the probe compared must be left as is.
+		 */
+		template<class Probe, class Fn>
+		bool modify(const Probe &probe, size_t hash, Fn &&fn) {
+			Node *first = head.load(std::memory_order_acquire);
+			if (first == nullptr)
+				return false;
+
+			Guard guard;
+			auto [ pred, curr, found ] = _find(first, probe, hash, guard);
+
+			// If we have a live node that matches us
+			if (!found || curr->next.getMark())
+				return false;
 
-			bool found = false;
+			fn(curr->val);
+			return true;
+		}
 
-			// If we have a real internal node that matches us
-			if (curr->val == val && !curr->next.getMark() && !curr->isCap) {
-				val = curr->val;
-				found = true;
+		/*
+		 * Hand every live item to fn, under a guard, so fn must not call
+		 * back into a list. Items added or removed meanwhile may or may not
+		 * be seen, but none is seen twice.
+		 */
+		template<class Fn>
+		void forEach(Fn &&fn) {
+			Node *first = head.load(std::memory_order_acquire);
+			if (first == nullptr)
+				return;
+
+			Guard guard;
+
+			// Nothing we can reach gets freed, so just follow next pointers,
+			// through removed nodes too. Nodes can't be linked in after a
+			// removed one, so we can't skip over a live node either
+			if constexpr (Reclaimer::PINS_REACHABLE) {
+				for (Node *curr = first->next.getRef(); !curr->isCap;) {
+					bool marked;
+					Node *succ = curr->next.getBoth(marked);
+					if (!marked)
+						fn(static_cast<const T &>(curr->val));
+					curr = succ;
+				}
+				return;
 			}
 
-			stopWatching(pred);
-			stopWatching(curr);
+			_forEachValidated(first, guard, fn);
+		}
+
+	private:
+		/*
+		 * Same walk as _find, minus the search, for reclaimers that only
+		 * keep protected nodes alive. Starting over means walking past
+		 * what we already handed out: sorted lists resume after the last
+		 * hash we passed, unsorted ones remember every node they passed.
+		 */
+		template<class Fn>
+		void _forEachValidated(Node *first, Guard &guard, Fn &&fn) {
+			Node *pred, *curr, *succ;
+			bool marked, predMarked;
+
+			// Last hash handed out, and the nodes with it
+			bool passedAny = false;
+			size_t lastHash = 0;
+			Node *lastNode = nullptr;
+			std::vector<Node *> sameHash; // Only filled by hash collisions
+
+			// Unsorted lists don't say where we were
+			std::unordered_set<Node *> seen;
+
+			auto alreadySeen = [&](Node *node) {
+				if (!passedAny)
+					return false;
+				if (!Sorted)
+					return seen.count(node) > 0;
+				if (node->hash != lastHash)
+					return node->hash < lastHash;
+				return node == lastNode || std::find(sameHash.begin(), sameHash.end(), node) != sameHash.end();
+			};
+
+			auto markSeen = [&](Node *node) {
+				if (!Sorted)
+					seen.insert(node);
+				else if (passedAny && node->hash == lastHash)
+					sameHash.push_back(lastNode);
+				else
+					sameHash.clear();
+				passedAny = true;
+				lastHash = node->hash;
+				lastNode = node;
+			};
+
+retry:;
+			pred = first;
+			curr = pred->next.getRef();
+			guard.protect(CURR_SLOT, curr);
+			if (pred->next.getRef() != curr)
+				goto retry;
+
+			while (!curr->isCap) {
+				succ = curr->next.getBoth(marked);
+				guard.protect(SUCC_SLOT, succ);
+
+				if (curr->next.getRef() != succ ||
+					pred->next.getBoth(predMarked) != curr || predMarked)
+					goto retry;
+
+				if (marked) {
+					Node *expectedRef = curr;
+					bool expectedMark = false;
+
+					if (!(pred->next.compareExchangeBothWeak(
+						expectedRef,
+						expectedMark,
+						succ,
+						false
+					)))
+						goto retry;
+
+					retire(curr);
+				} else {
+					if (!alreadySeen(curr)) {
+						markSeen(curr);
+						fn(static_cast<const T &>(curr->val));
+					}
+
+					pred = curr;
+					guard.protect(PRED_SLOT, pred);
+				}
 
-			return found;
+				curr = succ;
+				guard.protect(CURR_SLOT, curr);
+			}
 		}
 
+	public:
 		// Get current size
 		size_t size() { return curSize; }
+
+		// Bytes of the nodes we hold, caps included. Values' own heap
+		// memory and removed nodes waiting on the reclaimer aren't counted
+		size_t bytes() { return head.load() == nullptr ? 0 : (curSize + 2) * sizeof(Node); }
 	};
 
 	// Lock free linked list
 	// No support for deletion
-	template<class T>
+	// Sorted lists keep nodes in hash order, like LockFreeLL
+	// Instrument counts lost CAS races, see Instrumentation.h
+	template<
+		class T,
+		class Alloc = alloc::HeapAllocator,
+		bool Sorted = false,
+		class Instrument = instrument::Disabled
+	>
 	class AddOnlyLockFreeLL : ILinkedList<T> {
+	public:
+		// Same list, different node allocator
+		template<class A>
+		using WithAllocator = AddOnlyLockFreeLL<T, A, Sorted, Instrument>;
+
 	private:
 		// Regular linked list node
 		struct Node {
 			std::atomic<Node *> next = nullptr;
+			size_t hash = 0; // Cached so we compare it before the value
 			T val;
 
 			Node() {} // Dummy node for head
-			Node(T val) : val(val) {}
+			template<class... Args>
+			Node(size_t hash, Args&&... args) : hash(hash), val(std::forward<Args>(args)...) {}
 		};
 
-		// Size and head
+		// Size and head, null until the first add
 		std::atomic_size_t curSize;
-		Node *head;
+		std::atomic<Node *> head;
 
-	public:
-		// Construct
-		AddOnlyLockFreeLL() : curSize(0) {
-			head = new Node();
+		// Current head, allocating it if there is none
+		Node *materialize() {
+			Node *curr = head.load(std::memory_order_acquire);
+			if (curr != nullptr)
+				return curr;
+
+			Node *fresh = Alloc::template create<Node>();
+			if (head.compare_exchange_strong(curr, fresh, std::memory_order_acq_rel))
+				return fresh;
+
+			// Somebody beat us to it
+			Alloc::destroy(fresh);
+			return curr;
 		}
 
+	public:
+		// Construct empty, the head is made on the first add
+		AddOnlyLockFreeLL() : curSize(0), head(nullptr) {}
+
 		// Free everything
 		virtual ~AddOnlyLockFreeLL() {
-			Node *curr = head;
+			Node *curr = head.load();
 			while (curr != nullptr) {
 				Node *toRemove = curr;
 				curr = curr->next;
-				delete toRemove;
+				Alloc::destroy(toRemove);
 			}
 		}
 
-		// Get the head, not thread safe
+		// Get the head, null if nothing was ever added. Not thread safe
 		Node *NOT_THREAD_SAFE_getHead() { return head; }
 
-		// Add new element to the list
-		void add(const T &val) {
-			Node *toAdd = new Node(val);
+		// Cache hints for batched lookups, see prefetchBuckets
+		void prefetchHead() const { __builtin_prefetch(head.load(std::memory_order_relaxed)); }
+		void prefetchFirst() const {
+			Node *first = head.load(std::memory_order_relaxed);
+			if (first != nullptr)
+				__builtin_prefetch(first->next.load(std::memory_order_relaxed));
+		}
+
+	private:
+		/*
+		 * Find probe, or link a node built from args if it's missing.
+		 * onFound(match, spare) gets the match, and our node's value if
+		 * we built one before losing a race to it. Returns whether we
+		 * linked a new node.
+		 */
+		template<class Probe, class OnFound, class... Args>
+		bool _upsert(const Probe &probe, size_t hash, OnFound &&onFound, Args&&... args) {
+			Node *toAdd = nullptr;
+			Node *pred = materialize(), *curr = pred->next;
+
+			// Once built, our node is the probe since args may be moved into it
+			auto matches = [&](Node *node) {
+				if (node->hash != hash)
+					return false;
+				return toAdd == nullptr ? node->val == probe : node->val == toAdd->val;
+			};
 
 			// Keep going till we find success
 			while (true) {
-				Node *pred = head, *curr = head->next;
-
 				while (curr != nullptr) {
+					// Passed where it would be, insert before curr
+					if (Sorted && curr->hash > hash)
+						break;
+
 					// Found it, update
-					if (curr->val == val) {
-						curr->val = val;
-						delete toAdd;
-						return;
+					if (matches(curr)) {
+						onFound(curr->val, toAdd != nullptr ? &toAdd->val : nullptr);
+						if (toAdd != nullptr)
+							Alloc::destroy(toAdd);
+						return false;
 					}
 
 					pred = curr;
 					curr = curr->next;
 				}
 
-				// Connect new node
-				toAdd->next = curr;
+				// Only allocate once we know it's new
+				if (toAdd == nullptr)
+					toAdd = Alloc::template create<Node>(hash, std::forward<Args>(args)...);
+				toAdd->next.store(curr, std::memory_order_relaxed);
 
 				// Add with CAS
 				Node *expected = curr;
-				Node *required = toAdd;
 				if (pred->next.compare_exchange_weak(
 					expected,
-					required
+					toAdd
 				)) {
 					curSize++;
-					return;
+					return true;
 				}
+
+				// Nodes are never removed, so just
+				// keep scanning from whatever beat us
+				Instrument::count(instrument::ADD_ONLY_CAS_FAILURE);
+				curr = expected;
 			}
 		}
 
-		bool find(T &val) {
-			Node *curr = head->next;
+	public:
+		// Add new element to the list, optionally with its hash
+		// Existing elements are overwritten through assignValue, returns
+		// whether we added a new one
+		bool add(const T &val) { return add(val, hashOf(val)); }
+		bool add(const T &val, size_t hash) {
+			return _upsert(val, hash, [&val](T &match, T *) { assignValue(match, val); }, val);
+		}
+		bool add(T &&val, size_t hash) {
+			return _upsert(val, hash, [&val](T &match, T *spare) {
+				assignValue(match, std::move(spare != nullptr ? *spare : val));
+			}, std::move(val));
+		}
+
+		/*
+		 * Build an item from args right inside a new node, unless something
+		 * matching probe is already here. Returns whether we added it.
+		 */
+		template<class Probe, class... Args>
+		bool tryEmplace(const Probe &probe, size_t hash, Args&&... args) {
+			return _upsert(probe, hash, [](T &, T *) {}, std::forward<Args>(args)...);
+		}
+
+		/*
+		 * Same as tryEmplace, but hand whatever matched probe to fn, which
+		 * may race other writers of the same item. Args are only used
+		 * when nothing matched, and fn only runs when something did.
+		 * Returns whether we added a new item.
+		 */
+		template<class Probe, class Fn, class... Args>
+		bool findOrEmplace(const Probe &probe, size_t hash, Fn &&fn, Args&&... args) {
+			return _upsert(probe, hash, [&fn](T &match, T *) { fn(match); }, std::forward<Args>(args)...);
+		}
+
+		bool find(T &val) { return find(val, hashOf(val)); }
+		bool find(T &val, size_t hash) {
+			return visit(val, hash, [&val](const T &found) { val = found; });
+		}
+
+		// Find whatever matches a probe and hand it to fn, without copying
+		template<class Probe, class Fn>
+		bool visit(const Probe &probe, size_t hash, Fn &&fn) {
+			return modify(probe, hash, [&fn](T &found) { fn(static_cast<const T &>(found)); });
+		}
+
+		/*
+		 * Same as visit, but fn gets to change what it finds, racing other
+		 * writers of it. Whatever the probe compared must be left as is.
+		 */
+		template<class Probe, class Fn>
+		bool modify(const Probe &probe, size_t hash, Fn &&fn) {
+			Node *first = head.load(std::memory_order_acquire);
+			if (first == nullptr)
+				return false;
+
+			Node *curr = first->next;
 
 			while (curr != nullptr) {
+				// Passed where it would be
+				if (Sorted && curr->hash > hash)
+					return false;
+
 				// Found it
-				if (curr->val == val) {
-					val = curr->val;
+				if (curr->hash == hash && curr->val == probe) {
+					fn(curr->val);
 					return true;
 				}
 
@@ -352,12 +742,37 @@ retry:;
 			return false;
 		}
 
+		// Hand every item to fn, items added meanwhile may or may not be seen
+		template<class Fn>
+		void forEach(Fn &&fn) {
+			Node *first = head.load(std::memory_order_acquire);
+			if (first == nullptr)
+				return;
+
+			for (Node *curr = first->next; curr != nullptr; curr = curr->next)
+				fn(static_cast<const T &>(curr->val));
+		}
+
 		size_t size() { return curSize; }
+
+		// Bytes of the nodes we hold, head included. Values' own heap
+		// memory isn't counted
+		size_t bytes() { return head.load() == nullptr ? 0 : (curSize + 1) * sizeof(Node); }
 	};
 
 	// Hand over hand locked linked list
-	template<class T>
+	// Instrument counts and times waits for node locks, see Instrumentation.h
+	template<
+		class T,
+		class Alloc = alloc::HeapAllocator,
+		class Instrument = instrument::Disabled
+	>
 	class LockableLL : ILinkedList<T> {
+	public:
+		// Same list, different node allocator
+		template<class A>
+		using WithAllocator = LockableLL<T, A, Instrument>;
+
 	private:
 		// Lockable linked-list node
 		struct LockableNode {
@@ -368,37 +783,56 @@ retry:;
 		public:
 			// Member variables
 			LockableNode *next = nullptr;
+			size_t hash = 0; // Cached so we compare it before the value
 			T val;
 
 			// Construct
 			LockableNode() {} // Dummy node for head
-			LockableNode(T val) : val(val) {}
+			template<class... Args>
+			LockableNode(size_t hash, Args&&... args) : hash(hash), val(std::forward<Args>(args)...) {}
 
 			// Wrappers for thread control
-			void lock() { mtx.lock(); }
+			void lock() { instrument::lock<Instrument>(mtx); }
 			void unlock() { mtx.unlock(); }
 
 			// Lock the next node and return it
 			LockableNode *getNextAndLock() {
 				if (next == nullptr)
 					return nullptr;
-				next->mtx.lock();
+				next->lock();
 				return next;
 			}
 		};
 
-		// Member variables
-		LockableNode *head = new LockableNode();
+		// Member variables, head is null until the first add
+		std::atomic<LockableNode *> head;
 		std::atomic_size_t curSize;
 
+		// Current head, allocating it if there is none
+		LockableNode *materialize() {
+			LockableNode *curr = head.load(std::memory_order_acquire);
+			if (curr != nullptr)
+				return curr;
+
+			LockableNode *fresh = Alloc::template create<LockableNode>();
+			if (head.compare_exchange_strong(curr, fresh, std::memory_order_acq_rel))
+				return fresh;
+
+			// Somebody beat us to it
+			Alloc::destroy(fresh);
+			return curr;
+		}
+
 	public:
-		// Construct a new Linked-List
-		LockableLL() : curSize(0) {}
+		// Construct a new Linked-List, the head is made on the first add
+		LockableLL() : head(nullptr), curSize(0) {}
 
 		// Destructor, free all nodes
 		virtual ~LockableLL() {
 			// Obtain lock on head
-			LockableNode *mover = head;
+			LockableNode *mover = head.load();
+			if (mover == nullptr)
+				return;
 			mover->lock();
 
 			// Free everything
@@ -406,29 +840,45 @@ retry:;
 				LockableNode *next = mover->getNextAndLock();
 
 				mover->unlock();
-				delete mover;
+				Alloc::destroy(mover);
 
 				mover = next;
 			}
 		}
 
-		// Returns the head. Not thread safe
+		// Returns the head, null if nothing was ever added. Not thread safe
 		LockableNode *NOT_THREAD_SAFE_getHead() { return head; }
 
-		// Add new element to the linked list
-		void add(const T &val) {
+		// Cache hints for batched lookups, see prefetchBuckets.
+		// Racing on head->next is fine, a prefetch never faults
+		void prefetchHead() const { __builtin_prefetch(head.load(std::memory_order_relaxed)); }
+		void prefetchFirst() const {
+			LockableNode *first = head.load(std::memory_order_relaxed);
+			if (first != nullptr)
+				__builtin_prefetch(first->next);
+		}
+
+	private:
+		/*
+		 * Find probe, or append a node built from args if it's missing.
+		 * onFound(match, spare) gets the match under its lock, spare is
+		 * always null as we never build a node we don't link.
+		 * Returns whether we appended a new node.
+		 */
+		template<class Probe, class OnFound, class... Args>
+		bool _upsert(const Probe &probe, size_t hash, OnFound &&onFound, Args&&... args) {
 			// Maintain lock on cur node
-			LockableNode *mover = head;
+			LockableNode *mover = materialize();
 			mover->lock();
 
 			// Traverse the list
 			bool isHead = true;
 			while (true) {
 				// If we find it, update
-				if (!isHead && mover->val == val) {
-					mover->val = val;
+				if (!isHead && mover->hash == hash && mover->val == probe) {
+					onFound(mover->val, nullptr);
 					mover->unlock();
-					return;
+					return false;
 				}
 
 				// Lock our next node (if it exists)
@@ -444,16 +894,54 @@ retry:;
 			}
 
 			// Insert at end
-			mover->next = new LockableNode(val);
+			mover->next = Alloc::template create<LockableNode>(hash, std::forward<Args>(args)...);
 			mover->unlock();
 			curSize++;
+			return true;
+		}
+
+	public:
+		// Add new element to the linked list, optionally with its hash
+		// Existing elements are overwritten through assignValue, returns
+		// whether we added a new one
+		bool add(const T &val) { return add(val, hashOf(val)); }
+		bool add(const T &val, size_t hash) {
+			return _upsert(val, hash, [&val](T &match, T *) { assignValue(match, val); }, val);
+		}
+		bool add(T &&val, size_t hash) {
+			return _upsert(val, hash, [&val](T &match, T *spare) {
+				assignValue(match, std::move(spare != nullptr ? *spare : val));
+			}, std::move(val));
+		}
+
+		/*
+		 * Build an item from args right inside a new node, unless something
+		 * matching probe is already here. Returns whether we added it.
+		 */
+		template<class Probe, class... Args>
+		bool tryEmplace(const Probe &probe, size_t hash, Args&&... args) {
+			return _upsert(probe, hash, [](T &, T *) {}, std::forward<Args>(args)...);
+		}
+
+		/*
+		 * Same as tryEmplace, but hand whatever matched probe to fn, under
+		 * its lock. Args are only used when nothing matched, and fn only
+		 * runs when something did. Returns whether we added a new item.
+		 */
+		template<class Probe, class Fn, class... Args>
+		bool findOrEmplace(const Probe &probe, size_t hash, Fn &&fn, Args&&... args) {
+			return _upsert(probe, hash, [&fn](T &match, T *) { fn(match); }, std::forward<Args>(args)...);
 		}
 
 		// Remove an element
 		// Returns whether or not the value was successfully removed
-		bool remove(T val) {
+		bool remove(const T &val) { return remove(val, hashOf(val)); }
+		template<class Probe>
+		bool remove(const Probe &val, size_t hash) {
 			// Maintain lock on current node
-			LockableNode *mover = head;
+			LockableNode *mover = head.load(std::memory_order_acquire);
+			if (mover == nullptr)
+				return false;
 			mover->lock();
 
 			// Traverse, look for node to remove
@@ -468,12 +956,12 @@ retry:;
 				}
 
 				// Found it, remove
-				if (next->val == val) {
+				if (next->hash == hash && next->val == val) {
 					mover->next = next->next;
 					mover->unlock();
 					next->unlock();
 
-					delete next;
+					Alloc::destroy(next);
 					curSize--;
 
 					return true;
@@ -489,19 +977,42 @@ retry:;
 		}
 
 		// Return existence, store val in param
-		bool find(T &val) {
-			// Empty list
-			if (head->next == nullptr)
+		bool find(T &val) { return find(val, hashOf(val)); }
+		bool find(T &val, size_t hash) {
+			return visit(val, hash, [&val](const T &found) { val = found; });
+		}
+
+		// Find whatever matches a probe and hand it to fn under the node's lock
+		template<class Probe, class Fn>
+		bool visit(const Probe &probe, size_t hash, Fn &&fn) {
+			return modify(probe, hash, [&fn](T &found) { fn(static_cast<const T &>(found)); });
+		}
+
+		/*
+		 * Same as visit, but fn gets to change what it finds under its
+		 * lock. Whatever the probe compared must be left as is.
+		 */
+		template<class Probe, class Fn>
+		bool modify(const Probe &probe, size_t hash, Fn &&fn) {
+			// Never added to
+			LockableNode *first = head.load(std::memory_order_acquire);
+			if (first == nullptr)
 				return false;
 
-			// Maintain lock on current node
-			LockableNode *mover = head->next;
-			mover->lock();
+			// Step off the head hand over hand, the first node may be
+			// mid removal
+			first->lock();
+			LockableNode *mover = first->getNextAndLock();
+			first->unlock();
+
+			// Empty list
+			if (mover == nullptr)
+				return false;
 
 			// Check for existence
 			while (true) {
-				if (mover->val == val) {
-					val = mover->val;
+				if (mover->hash == hash && mover->val == probe) {
+					fn(mover->val);
 					mover->unlock();
 					return true;
 				}
@@ -520,7 +1031,455 @@ retry:;
 			}
 		}
 
+		// Hand every item to fn under its node's lock, stepping hand over hand
+		template<class Fn>
+		void forEach(Fn &&fn) {
+			LockableNode *first = head.load(std::memory_order_acquire);
+			if (first == nullptr)
+				return;
+
+			first->lock();
+			LockableNode *mover = first->getNextAndLock();
+			first->unlock();
+
+			while (mover != nullptr) {
+				fn(static_cast<const T &>(mover->val));
+				LockableNode *next = mover->getNextAndLock();
+				mover->unlock();
+				mover = next;
+			}
+		}
+
 		// Get the current size
 		size_t size() { return curSize; }
+
+		// Bytes of the nodes we hold, head and node locks included.
+		// Values' own heap memory isn't counted
+		size_t bytes() { return head.load() == nullptr ? 0 : (curSize + 1) * sizeof(LockableNode); }
+	};
+
+	/* Lock based ll with optimistic, lock free reads
+	 *
+	 * Writers take the list's mutex and bump its sequence counter to odd
+	 * while they change anything, then back to even. Readers never write
+	 * to the list: they note the counter, walk without locking, and
+	 * only trust what they saw if the counter didn't move meanwhile.
+	 * After a few failed tries a reader takes the mutex instead, so
+	 * readers can't be starved by a steady stream of writers.
+	 * Removed nodes go to the Reclaimer, as readers may still be on them.
+	 * Nodes come from the Alloc policy.
+	 */
+	template<
+		class T,
+		class Reclaimer = reclaim::EpochBased,
+		class Alloc = alloc::HeapAllocator
+	>
+	class SeqLockLL : ILinkedList<T> {
+	public:
+		// Same list, different node allocator
+		template<class A>
+		using WithAllocator = SeqLockLL<T, Reclaimer, A>;
+
+	private:
+		typedef typename Reclaimer::Guard Guard;
+
+		struct Node {
+			std::atomic<Node *> next;
+			size_t hash; // Cached so we compare it before the value
+			T val;
+
+			template<class... Args>
+			Node(size_t hash, Args&&... args)
+				: next(nullptr), hash(hash), val(std::forward<Args>(args)...) {}
+		};
+
+		// Optimistic walks a reader tries before it takes the lock
+		static const int OPTIMISTIC_TRIES = 4;
+
+		// Member variables, no dummy nodes so empty lists cost nothing
+		std::mutex mtx;
+		std::atomic<uint64_t> seq;
+		std::atomic<Node *> first;
+		std::atomic_size_t curSize;
+
+		// Hand an unlinked node to the reclaimer
+		static void retire(Node *node) {
+			Reclaimer::retire(node, [](void *ptr) {
+				Alloc::destroy(static_cast<Node *>(ptr));
+			});
+		}
+
+		// Writers wrap every change in these, under the lock
+		void beginWrite() { seq.store(seq.load(std::memory_order_relaxed) + 1); }
+		void endWrite() { seq.store(seq.load(std::memory_order_relaxed) + 1); }
+
+		// Link pointing at whatever matches probe, or at the tail's null. Lock must be held
+		template<class Probe>
+		std::atomic<Node *> *_findLink(const Probe &probe, size_t hash) {
+			std::atomic<Node *> *link = &first;
+			for (Node *curr = link->load(); curr != nullptr; curr = link->load()) {
+				if (curr->hash == hash && curr->val == probe)
+					return link;
+				link = &curr->next;
+			}
+			return link;
+		}
+
+		/*
+		 * Walk to probe without locking, under guard.
+		 * Returns whether the walk was consistent, and if so found is
+		 * the match or null. Each node is protected before the counter
+		 * is checked, so a node we step onto was still linked.
+		 */
+		template<class Probe>
+		bool _tryFind(const Probe &probe, size_t hash, Guard &guard, Node *&found) {
+			uint64_t before = seq.load();
+			if (before & 1)
+				return false;
+
+			int slot = 0;
+			Node *curr = first.load();
+			guard.protect(slot, curr);
+			while (true) {
+				if (seq.load() != before)
+					return false;
+				if (curr == nullptr || (curr->hash == hash && curr->val == probe)) {
+					found = curr;
+					return true;
+				}
+
+				Node *next = curr->next.load();
+				slot ^= 1;
+				guard.protect(slot, next);
+				curr = next;
+			}
+		}
+
+		/*
+		 * Find probe, or append a node built from args if it's missing.
+		 * onFound(match, spare) gets the match under the lock, spare is
+		 * always null as we never build a node we don't link.
+		 * Returns whether we appended a new node.
+		 */
+		template<class Probe, class OnFound, class... Args>
+		bool _upsert(const Probe &probe, size_t hash, OnFound &&onFound, Args&&... args) {
+			std::lock_guard<std::mutex> lock(mtx);
+			std::atomic<Node *> *link = _findLink(probe, hash);
+
+			Node *match = link->load();
+			if (match != nullptr) {
+				beginWrite();
+				onFound(match->val, nullptr);
+				endWrite();
+				return false;
+			}
+
+			// Fully built before readers can reach it
+			Node *node = Alloc::template create<Node>(hash, std::forward<Args>(args)...);
+			beginWrite();
+			link->store(node);
+			endWrite();
+			curSize++;
+			return true;
+		}
+
+	public:
+		// Construct empty
+		SeqLockLL() : seq(0), first(nullptr), curSize(0) {}
+
+		// Destruct, free all nodes
+		virtual ~SeqLockLL() {
+			Node *curr = first.load();
+			while (curr != nullptr) {
+				Node *next = curr->next.load();
+				Alloc::destroy(curr);
+				curr = next;
+			}
+		}
+
+		// Returns the first node, null if the list is empty. Not thread safe
+		Node *NOT_THREAD_SAFE_getHead() { return first; }
+
+		// Cache hints for batched lookups, see prefetchBuckets.
+		// There's no dummy head, and the first node may be freed under
+		// us, so we can't look past it
+		void prefetchHead() const { __builtin_prefetch(first.load(std::memory_order_relaxed)); }
+		void prefetchFirst() const {}
+
+		// Add new element to the linked list, optionally with its hash
+		// Existing elements are overwritten through assignValue, returns
+		// whether we added a new one
+		bool add(const T &val) { return add(val, hashOf(val)); }
+		bool add(const T &val, size_t hash) {
+			return _upsert(val, hash, [&val](T &match, T *) { assignValue(match, val); }, val);
+		}
+		bool add(T &&val, size_t hash) {
+			return _upsert(val, hash, [&val](T &match, T *spare) {
+				assignValue(match, std::move(spare != nullptr ? *spare : val));
+			}, std::move(val));
+		}
+
+		/*
+		 * Build an item from args right inside a new node, unless something
+		 * matching probe is already here. Returns whether we added it.
+		 */
+		template<class Probe, class... Args>
+		bool tryEmplace(const Probe &probe, size_t hash, Args&&... args) {
+			return _upsert(probe, hash, [](T &, T *) {}, std::forward<Args>(args)...);
+		}
+
+		/*
+		 * Same as tryEmplace, but hand whatever matched probe to fn, under
+		 * the list's lock. Args are only used when nothing matched, and fn
+		 * only runs when something did. Returns whether we added a new
+		 * item.
+		 */
+		template<class Probe, class Fn, class... Args>
+		bool findOrEmplace(const Probe &probe, size_t hash, Fn &&fn, Args&&... args) {
+			return _upsert(probe, hash, [&fn](T &match, T *) { fn(match); }, std::forward<Args>(args)...);
+		}
+
+		// Remove item from list, or whatever matches a probe with its hash
+		bool remove(const T &val) { return remove(val, hashOf(val)); }
+		template<class Probe>
+		bool remove(const Probe &probe, size_t hash) {
+			std::lock_guard<std::mutex> lock(mtx);
+			std::atomic<Node *> *link = _findLink(probe, hash);
+
+			Node *match = link->load();
+			if (match == nullptr)
+				return false;
+
+			beginWrite();
+			link->store(match->next.load());
+			endWrite();
+			retire(match);
+			curSize--;
+			return true;
+		}
+
+		// Returns true if the item is in the list, parameter updated
+		bool find(T &val) { return find(val, hashOf(val)); }
+		bool find(T &val, size_t hash) {
+			return visit(val, hash, [&val](const T &found) { val = found; });
+		}
+
+		/*
+		 * Find whatever matches a probe and hand it to fn, without copying
+		 * or locking. The node is kept alive until fn returns, but may be
+		 * removed or written to concurrently. Returns whether anything
+		 * matched.
+		 */
+		template<class Probe, class Fn>
+		bool visit(const Probe &probe, size_t hash, Fn &&fn) {
+			if (first.load(std::memory_order_acquire) == nullptr)
+				return false;
+
+			for (int tries = 0; tries < OPTIMISTIC_TRIES; tries++) {
+				Guard guard;
+				Node *found;
+				if (!_tryFind(probe, hash, guard, found))
+					continue;
+				if (found == nullptr)
+					return false;
+				fn(static_cast<const T &>(found->val));
+				return true;
+			}
+
+			// Too much churn, wait our turn
+			std::lock_guard<std::mutex> lock(mtx);
+			Node *found = _findLink(probe, hash)->load();
+			if (found == nullptr)
+				return false;
+			fn(static_cast<const T &>(found->val));
+			return true;
+		}
+
+		/*
+		 * Same as visit, but fn gets to change what it finds, under the
+		 * lock. Whatever the probe compared must be left as is.
+		 */
+		template<class Probe, class Fn>
+		bool modify(const Probe &probe, size_t hash, Fn &&fn) {
+			std::lock_guard<std::mutex> lock(mtx);
+			Node *found = _findLink(probe, hash)->load();
+			if (found == nullptr)
+				return false;
+			beginWrite();
+			fn(found->val);
+			endWrite();
+			return true;
+		}
+
+		// Hand every item to fn under the lock
+		template<class Fn>
+		void forEach(Fn &&fn) {
+			std::lock_guard<std::mutex> lock(mtx);
+			for (Node *curr = first.load(); curr != nullptr; curr = curr->next.load())
+				fn(static_cast<const T &>(curr->val));
+		}
+
+		// Get the current size
+		size_t size() { return curSize; }
+
+		// Bytes of the nodes we hold. Values' own heap memory and
+		// removed nodes waiting on the reclaimer aren't counted
+		size_t bytes() { return curSize * sizeof(Node); }
+	};
+
+	// Bucket lists kept in hash order, for Hashmap and Hashset
+	template<class T>
+	using SortedLockFreeLL = LockFreeLL<T, reclaim::EpochBased, alloc::HeapAllocator, true>;
+	template<class T>
+	using SortedAddOnlyLockFreeLL = AddOnlyLockFreeLL<T, alloc::HeapAllocator, true>;
+
+	/*
+	 * Warm the cache for a batch of buckets before touching them.
+	 *
+	 * Each pass issues one dependent load per bucket: first the bucket
+	 * objects, then their head nodes, then the first real node of each
+	 * chain. Every pass overlaps its misses across the whole batch,
+	 * instead of paying them one after another like a scalar loop.
+	 */
+	template<class Bucket>
+	void prefetchBuckets(const Bucket *buckets, const size_t *indices, size_t count) {
+		for (size_t i = 0; i < count; i++)
+			__builtin_prefetch(&buckets[indices[i]]);
+		for (size_t i = 0; i < count; i++)
+			buckets[indices[i]].prefetchHead();
+		for (size_t i = 0; i < count; i++)
+			buckets[indices[i]].prefetchFirst();
+	}
+
+	// How a vector of buckets is loaded, see bucketStats
+	struct BucketStats {
+		size_t buckets = 0;
+		size_t usedBuckets = 0; // Holding at least one item
+		size_t items = 0;
+		size_t maxChain = 0;
+		std::vector<size_t> chainHistogram; // [n] is how many buckets hold n items
+		size_t p50Chain = 0, p90Chain = 0, p99Chain = 0; // Over used buckets only
+		double loadFactor = 0; // Items per bucket
+
+		// Estimated memory, not counting what the items point to
+		size_t nodeBytes = 0;   // Nodes and caps
+		size_t bucketBytes = 0; // The buckets themselves
+		size_t filterBytes = 0; // Bloom filter in front of them, if any
+
+		size_t totalBytes() const { return nodeBytes + bucketBytes + filterBytes; }
+		double bytesPerItem() const { return items == 0 ? 0 : (double)totalBytes() / items; }
+	};
+
+	/*
+	 * Gather BucketStats over count buckets, split across threads.
+	 * Only each bucket's size and bytes are read, so nothing is locked
+	 * or walked, but on a live table the numbers are a blend of moments.
+	 */
+	template<class Bucket>
+	BucketStats bucketStats(Bucket *buckets, size_t count, uint threads = parallel::defaultThreads()) {
+		BucketStats stats;
+		std::mutex statsMtx;
+
+		parallel::forEachChunk(count, threads, [&](size_t begin, size_t end) {
+			std::vector<size_t> histogram;
+			size_t items = 0, nodeBytes = 0;
+			for (size_t i = begin; i < end; i++) {
+				size_t chain = buckets[i].size();
+				if (chain >= histogram.size())
+					histogram.resize(chain + 1);
+				histogram[chain]++;
+				items += chain;
+				nodeBytes += buckets[i].bytes();
+			}
+
+			std::lock_guard<std::mutex> lock(statsMtx);
+			if (histogram.size() > stats.chainHistogram.size())
+				stats.chainHistogram.resize(histogram.size());
+			for (size_t chain = 0; chain < histogram.size(); chain++)
+				stats.chainHistogram[chain] += histogram[chain];
+			stats.items += items;
+			stats.nodeBytes += nodeBytes;
+		}, 1024);
+
+		stats.buckets = count;
+		stats.bucketBytes = count * sizeof(Bucket);
+		stats.loadFactor = count == 0 ? 0 : (double)stats.items / count;
+		stats.maxChain = stats.chainHistogram.empty() ? 0 : stats.chainHistogram.size() - 1;
+		stats.usedBuckets = count - (stats.chainHistogram.empty() ? 0 : stats.chainHistogram[0]);
+
+		// Walk the histogram once, noting where each percentile lands
+		size_t seen = 0;
+		size_t *percentiles[] = {&stats.p50Chain, &stats.p90Chain, &stats.p99Chain};
+		const double RANKS[] = {0.5, 0.9, 0.99};
+		for (size_t chain = 1, next = 0; chain < stats.chainHistogram.size() && next < 3; chain++) {
+			seen += stats.chainHistogram[chain];
+			while (next < 3 && seen >= RANKS[next] * stats.usedBuckets)
+				*percentiles[next++] = chain;
+		}
+		return stats;
+	}
+
+	/* Weakly consistent forward iterator over a vector of buckets
+	 *
+	 * Copies one bucket at a time out through its forEach and hands out
+	 * the copies, so it never points into a node that may be freed and
+	 * writers are only held up while a bucket is copied, if at all.
+	 * Each bucket is read once: items added or removed meanwhile may or
+	 * may not be seen, but none is seen twice.
+	 * Convert turns a bucket's item into a value_type.
+	 */
+	template<class Bucket, class Item, class Convert>
+	class SnapshotIterator {
+	public:
+		typedef std::forward_iterator_tag iterator_category;
+		typedef Item value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const Item *pointer;
+		typedef const Item &reference;
+
+		// Start at bucket, count being one past the last
+		SnapshotIterator(Bucket *buckets, size_t count, size_t bucket)
+			: buckets(buckets), count(count), bucket(bucket), pos(0) { fill(); }
+
+		reference operator*() const { return items[pos]; }
+		pointer operator->() const { return &items[pos]; }
+
+		SnapshotIterator &operator++() {
+			if (++pos == items.size()) {
+				bucket++;
+				fill();
+			}
+			return *this;
+		}
+
+		SnapshotIterator operator++(int) {
+			SnapshotIterator before = *this;
+			++*this;
+			return before;
+		}
+
+		// Iterators over the same buckets only
+		bool operator==(const SnapshotIterator &other) const {
+			return bucket == other.bucket && pos == other.pos;
+		}
+		bool operator!=(const SnapshotIterator &other) const { return !(*this == other); }
+
+	private:
+		Bucket *buckets;
+		size_t count;
+		size_t bucket; // Where items came from, count once we're done
+		size_t pos;
+		std::vector<Item> items;
+
+		// Copy out the first non empty bucket from here on
+		void fill() {
+			items.clear();
+			pos = 0;
+			for (; bucket < count; bucket++) {
+				buckets[bucket].forEach([this](const auto &item) { items.push_back(Convert()(item)); });
+				if (!items.empty())
+					return;
+			}
+		}
 	};
 };
@@ -1,10 +1,14 @@
+#pragma once
+
 #include <atomic>
 #include <assert.h>
+#include "Instrumentation.h"
 
 using std::atomic;
 
-// Markable reference with atomic operations
-template<class T>
+// Markable reference with atomic operations,
+// Instrument counts contention, see Instrumentation.h
+template<class T, class Instrument = instrument::Disabled>
 class MarkableReference
 {
 private:
@@ -76,6 +80,8 @@ public:
         do {
             uintptr_t newval = reinterpret_cast<uintptr_t>(ref) | (old & mask);
             success = val.compare_exchange_weak(old, newval, order);
+            if (!success)
+                Instrument::count(instrument::EXCHANGE_REF_CAS_FAILURE);
         } while(!success);
 
         return reinterpret_cast<T *>(old & ~mask);
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <new>
+#include <mutex>
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+/*
+ * Node allocation policies for the containers
+ *
+ * A policy creates and destroys whole nodes:
+ *  - HeapAllocator: plain new and delete
+ *  - PooledAllocator: thread caching size class pool that recycles nodes
+ */
+namespace alloc {
+
+	// Straight to the global allocator
+	struct HeapAllocator {
+		template<class Node, class... Args>
+		static Node *create(Args&&... args) {
+			return new Node(std::forward<Args>(args)...);
+		}
+
+		template<class Node>
+		static void destroy(Node *node) {
+			delete node;
+		}
+	};
+
+	/* Thread caching node pool
+	 *
+	 * Nodes are bucketed into 16 byte size classes. Each thread keeps a
+	 * free list per class and only touches the shared (locked) free list
+	 * to move a whole batch in or out, so steady state allocation is a
+	 * couple of pointer writes. Memory is carved from 64KB slabs and is
+	 * kept for the life of the process. Nodes larger than the biggest
+	 * class, or over-aligned, fall through to the heap.
+	 */
+	class PooledAllocator {
+	public:
+		static const size_t GRANULE = 16;
+		static const size_t CLASSES = 32;
+		static const size_t SLAB_BYTES = 64 * 1024;
+		static const size_t BATCH = 64;
+
+		// Bytes held by the pool, across all size classes
+		struct Footprint {
+			size_t reservedBytes;    // Carved from the heap in slabs
+			size_t centralFreeBytes; // Free and waiting in the shared lists
+			size_t outstandingBytes; // In use, or cached by a thread
+		};
+
+	private:
+		struct FreeNode {
+			FreeNode *next;
+		};
+
+		// Shared free list for one size class
+		struct Central {
+			std::mutex mtx;
+			FreeNode *head = nullptr;
+			size_t freeCount = 0;
+			size_t carvedCount = 0;
+			std::vector<char *> slabs;
+		};
+
+		// One thread's free lists
+		struct Cache {
+			FreeNode *head[CLASSES] = {};
+			size_t count[CLASSES] = {};
+		};
+
+		// Never destroyed, so nodes freed during static destruction
+		// still have somewhere to go
+		static Central *centrals() {
+			static Central *c = new Central[CLASSES];
+			return c;
+		}
+
+		// Flushes the thread's cache when the thread exits
+		struct CacheOwner {
+			Cache cache;
+			~CacheOwner();
+		};
+
+		// Plain pointers stay usable after the owner is gone
+		static Cache *&cachePtr() {
+			static thread_local Cache *cache = nullptr;
+			return cache;
+		}
+		static bool &exited() {
+			static thread_local bool gone = false;
+			return gone;
+		}
+
+		// Thread cache, or null once this thread is shutting down
+		static Cache *localCache() {
+			Cache *&cache = cachePtr();
+			if (cache == nullptr && !exited()) {
+				static thread_local CacheOwner owner;
+				cache = &owner.cache;
+			}
+			return cache;
+		}
+
+		static constexpr size_t slotSize(size_t sizeClass) { return (sizeClass + 1) * GRANULE; }
+
+		// Move up to count nodes from the shared list, carving a slab if empty
+		static FreeNode *takeBatch(size_t sizeClass, size_t &count) {
+			Central &central = centrals()[sizeClass];
+			std::lock_guard<std::mutex> lock(central.mtx);
+
+			if (central.head == nullptr) {
+				char *slab = static_cast<char *>(::operator new(SLAB_BYTES));
+				central.slabs.push_back(slab);
+
+				size_t slot = slotSize(sizeClass);
+				for (size_t offset = 0; offset + slot <= SLAB_BYTES; offset += slot) {
+					FreeNode *node = reinterpret_cast<FreeNode *>(slab + offset);
+					node->next = central.head;
+					central.head = node;
+					central.freeCount++;
+					central.carvedCount++;
+				}
+			}
+
+			FreeNode *first = central.head, *last = first;
+			size_t taken = 1;
+			while (taken < count && last->next != nullptr) {
+				last = last->next;
+				taken++;
+			}
+			central.head = last->next;
+			central.freeCount -= taken;
+			last->next = nullptr;
+
+			count = taken;
+			return first;
+		}
+
+		// Hand a chain of nodes back to the shared list
+		static void giveBatch(size_t sizeClass, FreeNode *first, FreeNode *last, size_t count) {
+			Central &central = centrals()[sizeClass];
+			std::lock_guard<std::mutex> lock(central.mtx);
+			last->next = central.head;
+			central.head = first;
+			central.freeCount += count;
+		}
+
+		static void *allocate(size_t sizeClass) {
+			Cache *cache = localCache();
+
+			// No cache left on this thread, go straight to the shared list
+			if (cache == nullptr) {
+				size_t count = 1;
+				return takeBatch(sizeClass, count);
+			}
+
+			if (cache->head[sizeClass] == nullptr) {
+				size_t count = BATCH;
+				cache->head[sizeClass] = takeBatch(sizeClass, count);
+				cache->count[sizeClass] = count;
+			}
+
+			FreeNode *node = cache->head[sizeClass];
+			cache->head[sizeClass] = node->next;
+			cache->count[sizeClass]--;
+			return node;
+		}
+
+		static void deallocate(void *ptr, size_t sizeClass) {
+			FreeNode *node = static_cast<FreeNode *>(ptr);
+			Cache *cache = localCache();
+
+			if (cache == nullptr) {
+				giveBatch(sizeClass, node, node, 1);
+				return;
+			}
+
+			node->next = cache->head[sizeClass];
+			cache->head[sizeClass] = node;
+
+			// Too much hoarded, give a batch back
+			if (++cache->count[sizeClass] > 2 * BATCH) {
+				FreeNode *last = node;
+				for (size_t i = 1; i < BATCH; i++)
+					last = last->next;
+				cache->head[sizeClass] = last->next;
+				cache->count[sizeClass] -= BATCH;
+				giveBatch(sizeClass, node, last, BATCH);
+			}
+		}
+
+		// Size class for a node type, or CLASSES if it goes to the heap
+		template<class Node>
+		static constexpr size_t classOf() {
+			if (alignof(Node) > GRANULE)
+				return CLASSES;
+			size_t sizeClass = (sizeof(Node) + GRANULE - 1) / GRANULE - 1;
+			return sizeClass < CLASSES ? sizeClass : CLASSES;
+		}
+
+	public:
+		template<class Node, class... Args>
+		static Node *create(Args&&... args) {
+			constexpr size_t sizeClass = classOf<Node>();
+			if (sizeClass == CLASSES)
+				return new Node(std::forward<Args>(args)...);
+			return new (allocate(sizeClass)) Node(std::forward<Args>(args)...);
+		}
+
+		template<class Node>
+		static void destroy(Node *node) {
+			constexpr size_t sizeClass = classOf<Node>();
+			if (sizeClass == CLASSES) {
+				delete node;
+				return;
+			}
+			node->~Node();
+			deallocate(node, sizeClass);
+		}
+
+		// Current pool footprint
+		static Footprint footprint() {
+			Footprint total = { 0, 0, 0 };
+			for (size_t sizeClass = 0; sizeClass < CLASSES; sizeClass++) {
+				Central &central = centrals()[sizeClass];
+				std::lock_guard<std::mutex> lock(central.mtx);
+				size_t slot = slotSize(sizeClass);
+				total.reservedBytes += central.slabs.size() * SLAB_BYTES;
+				total.centralFreeBytes += central.freeCount * slot;
+				total.outstandingBytes += (central.carvedCount - central.freeCount) * slot;
+			}
+			return total;
+		}
+	};
+
+	// Give every cached node back on thread exit
+	inline PooledAllocator::CacheOwner::~CacheOwner() {
+		for (size_t sizeClass = 0; sizeClass < CLASSES; sizeClass++) {
+			FreeNode *first = cache.head[sizeClass];
+			if (first == nullptr)
+				continue;
+			FreeNode *last = first;
+			while (last->next != nullptr)
+				last = last->next;
+			giveBatch(sizeClass, first, last, cache.count[sizeClass]);
+		}
+		cachePtr() = nullptr;
+		exited() = true;
+	}
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+
+// Helpers for spreading bulk work over threads
+namespace parallel {
+
+	// Thread count to use when the caller doesn't pick one
+	inline uint defaultThreads() {
+		uint threads = std::thread::hardware_concurrency();
+		return threads == 0 ? 1 : threads;
+	}
+
+	/*
+	 * Run fn(begin, end) over [0, count) a chunk at a time, on up to
+	 * threads threads, the caller being one of them. Threads claim chunks
+	 * off a shared counter, so uneven chunks balance themselves out.
+	 * Returns once every chunk is done.
+	 */
+	template<class Fn>
+	void forEachChunk(size_t count, uint threads, Fn &&fn, size_t chunk = 64) {
+		std::atomic<size_t> next(0);
+		auto work = [&]() {
+			size_t begin;
+			while ((begin = next.fetch_add(chunk, std::memory_order_relaxed)) < count)
+				fn(begin, std::min(count, begin + chunk));
+		};
+
+		// No point in more threads than chunks
+		size_t chunks = (count + chunk - 1) / chunk;
+		threads = (uint)std::min<size_t>(std::max(threads, 1u), std::max<size_t>(chunks, 1));
+
+		std::vector<std::thread> helpers;
+		for (uint i = 1; i < threads; i++)
+			helpers.emplace_back(work);
+		work();
+		for (std::thread &t : helpers)
+			t.join();
+	}
+};
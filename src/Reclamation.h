@@ -0,0 +1,362 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+#include <cstdint>
+#include <assert.h>
+
+/*
+ * Safe memory reclamation for lock free containers
+ *
+ * A container opens a Guard for the duration of an operation,
+ * publishes the nodes it is about to dereference with protect(slot, node),
+ * and hands unlinked nodes to retire() instead of deleting them.
+ * Retired nodes are freed in batches once no guard can still see them.
+ *
+ * Policies share the same interface so containers can take them
+ * as a template parameter:
+ *  - EpochBased: protect is free, a guard pins the current epoch
+ *  - HazardPointers: protect publishes the pointer, bounded garbage
+ *
+ * Guards may nest on a thread, e.g. when a callback run under one
+ * calls back into a container. Inner guards never weaken outer ones.
+ */
+namespace reclaim {
+
+	// Type erased retired node
+	struct Retired {
+		void *ptr;
+		void (*deleter)(void *);
+		uint64_t epoch;
+
+		void free() { deleter(ptr); }
+	};
+
+	// Per-thread records are kept in a push-only list and reused
+	// by later threads, so they never need to be freed
+	template<class Record>
+	class Registry {
+	private:
+		std::atomic<Record *> head;
+
+	public:
+		Registry() : head(nullptr) {}
+
+		// Claim an unused record or make a new one
+		Record *acquire() {
+			for (Record *rec = head.load(); rec != nullptr; rec = rec->next) {
+				bool expected = false;
+				if (!rec->inUse.load() && rec->inUse.compare_exchange_strong(expected, true))
+					return rec;
+			}
+
+			Record *rec = new Record();
+			rec->inUse = true;
+			Record *expected = head.load();
+			do {
+				rec->next = expected;
+			} while (!head.compare_exchange_weak(expected, rec));
+			return rec;
+		}
+
+		Record *begin() { return head.load(); }
+	};
+
+	// Nodes left behind by exited threads, adopted by whoever scans next
+	class Orphans {
+	private:
+		std::mutex mtx;
+		std::vector<Retired> nodes;
+
+	public:
+		// Only runs at static destruction, when no guard can be open
+		~Orphans() {
+			for (Retired &r : nodes)
+				r.free();
+		}
+
+		void give(std::vector<Retired> &from) {
+			std::lock_guard<std::mutex> lock(mtx);
+			nodes.insert(nodes.end(), from.begin(), from.end());
+			from.clear();
+		}
+
+		void take(std::vector<Retired> &into) {
+			std::lock_guard<std::mutex> lock(mtx);
+			into.insert(into.end(), nodes.begin(), nodes.end());
+			nodes.clear();
+		}
+	};
+
+	/* Epoch based reclamation
+	 *
+	 * Guards announce the global epoch they started in. A node retired
+	 * in epoch e can be freed once the global epoch reaches e + 2, which
+	 * can only happen after every guard that was open during e has closed.
+	 * Traversals do no writes at all, one announcement per operation.
+	 */
+	class EpochBased {
+	public:
+		// A guard keeps every node it can reach alive, even unlinked ones
+		static const bool PINS_REACHABLE = true;
+
+	private:
+		// How many retires between attempts to advance and free
+		static const size_t BATCH = 64;
+
+		// Announcement is (epoch << 1) | 1 while inside a guard, 0 outside
+		struct Record {
+			std::atomic<uint64_t> announce{0};
+			std::atomic<bool> inUse{false};
+			Record *next = nullptr;
+		};
+
+		struct Domain {
+			std::atomic<uint64_t> epoch{1};
+			Registry<Record> records;
+			Orphans orphans;
+		};
+
+		static Domain &domain() {
+			static Domain d;
+			return d;
+		}
+
+		// Thread local state, hands leftovers to the orphans on thread exit
+		struct Local {
+			Record *rec = nullptr;
+			std::vector<Retired> retired;
+			size_t sinceScan = 0;
+			size_t depth = 0; // Guards open on this thread
+
+			Record *record() {
+				if (rec == nullptr)
+					rec = domain().records.acquire();
+				return rec;
+			}
+
+			~Local() {
+				if (!retired.empty())
+					domain().orphans.give(retired);
+				if (rec != nullptr)
+					rec->inUse = false;
+			}
+		};
+
+		static Local &local() {
+			static thread_local Local l;
+			return l;
+		}
+
+		// Advance the epoch if every active guard has caught up,
+		// then free anything two epochs old
+		static void scan(Local &l) {
+			Domain &d = domain();
+			uint64_t epoch = d.epoch.load();
+
+			bool caughtUp = true;
+			for (Record *rec = d.records.begin(); rec != nullptr; rec = rec->next) {
+				uint64_t announce = rec->announce.load();
+				if ((announce & 1) && (announce >> 1) != epoch) {
+					caughtUp = false;
+					break;
+				}
+			}
+			if (caughtUp && d.epoch.compare_exchange_strong(epoch, epoch + 1))
+				epoch++;
+
+			d.orphans.take(l.retired);
+
+			auto stillVisible = std::partition(
+				l.retired.begin(),
+				l.retired.end(),
+				[epoch](const Retired &r) { return r.epoch + 2 > epoch; }
+			);
+			for (auto it = stillVisible; it != l.retired.end(); it++)
+				it->free();
+			l.retired.erase(stillVisible, l.retired.end());
+		}
+
+	public:
+		class Guard {
+		private:
+			Record *rec;
+
+		public:
+			// Only the outermost guard announces, inner ones are
+			// already covered by its epoch
+			Guard() {
+				Local &l = local();
+				rec = l.record();
+				if (l.depth++ > 0)
+					return;
+				rec->announce.store((domain().epoch.load() << 1) | 1);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+			}
+
+			~Guard() {
+				if (--local().depth == 0)
+					rec->announce.store(0, std::memory_order_release);
+			}
+
+			Guard(const Guard &) = delete;
+			Guard &operator=(const Guard &) = delete;
+
+			// The epoch already covers every node we can reach
+			template<class Node>
+			void protect(int, Node *) {}
+		};
+
+		// Free a node once no guard can still see it
+		static void retire(void *ptr, void (*deleter)(void *)) {
+			Local &l = local();
+			l.retired.push_back({ ptr, deleter, domain().epoch.load() });
+			if (++l.sinceScan >= BATCH) {
+				l.sinceScan = 0;
+				scan(l);
+			}
+		}
+
+		template<class Node>
+		static void retire(Node *node) {
+			retire(node, [](void *ptr) { delete static_cast<Node *>(ptr); });
+		}
+	};
+
+	/* Hazard pointer reclamation
+	 *
+	 * Each guard owns a few slots where it publishes the nodes it is
+	 * about to dereference. Callers must re-validate that a node is still
+	 * reachable after protecting it. Retired nodes are freed in batches
+	 * once they show up in no thread's slots.
+	 */
+	class HazardPointers {
+	public:
+		static const int SLOTS = 3;
+
+		// Only protected nodes are kept alive, walks must revalidate
+		static const bool PINS_REACHABLE = false;
+
+	private:
+		// How many retires between scans
+		static const size_t BATCH = 64;
+
+		struct Record {
+			std::atomic<void *> hazards[SLOTS];
+			std::atomic<bool> inUse{false};
+			Record *next = nullptr;
+
+			Record() {
+				for (auto &hazard : hazards)
+					hazard = nullptr;
+			}
+		};
+
+		struct Domain {
+			Registry<Record> records;
+			Orphans orphans;
+		};
+
+		static Domain &domain() {
+			static Domain d;
+			return d;
+		}
+
+		// Thread local state, hands leftovers to the orphans on thread exit
+		struct Local {
+			Record *rec = nullptr;
+			std::vector<Retired> retired;
+			size_t depth = 0; // Guards open on this thread
+
+			Record *record() {
+				if (rec == nullptr)
+					rec = domain().records.acquire();
+				return rec;
+			}
+
+			~Local() {
+				if (!retired.empty())
+					domain().orphans.give(retired);
+				if (rec != nullptr)
+					rec->inUse = false;
+			}
+		};
+
+		static Local &local() {
+			static thread_local Local l;
+			return l;
+		}
+
+		// Free everything that isn't currently protected
+		static void scan(Local &l) {
+			Domain &d = domain();
+			d.orphans.take(l.retired);
+
+			std::vector<void *> protectedPtrs;
+			for (Record *rec = d.records.begin(); rec != nullptr; rec = rec->next)
+				for (auto &hazard : rec->hazards)
+					if (void *ptr = hazard.load())
+						protectedPtrs.push_back(ptr);
+			std::sort(protectedPtrs.begin(), protectedPtrs.end());
+
+			auto stillVisible = std::partition(
+				l.retired.begin(),
+				l.retired.end(),
+				[&protectedPtrs](const Retired &r) {
+					return std::binary_search(protectedPtrs.begin(), protectedPtrs.end(), r.ptr);
+				}
+			);
+			for (auto it = stillVisible; it != l.retired.end(); it++)
+				it->free();
+			l.retired.erase(stillVisible, l.retired.end());
+		}
+
+	public:
+		class Guard {
+		private:
+			Record *rec;
+
+		public:
+			// The outermost guard uses the thread's record, nested ones
+			// claim a record of their own so their slots don't overlap
+			Guard() {
+				Local &l = local();
+				rec = l.depth++ == 0 ? l.record() : domain().records.acquire();
+			}
+
+			~Guard() {
+				for (auto &hazard : rec->hazards)
+					hazard.store(nullptr, std::memory_order_release);
+
+				Local &l = local();
+				if (--l.depth > 0)
+					rec->inUse.store(false, std::memory_order_release);
+			}
+
+			Guard(const Guard &) = delete;
+			Guard &operator=(const Guard &) = delete;
+
+			// Publish a node we are about to dereference
+			template<class Node>
+			void protect(int slot, Node *node) {
+				assert(slot >= 0 && slot < SLOTS && "hazard slot out of range");
+				rec->hazards[slot].store(node);
+			}
+		};
+
+		// Free a node once no hazard pointer covers it
+		static void retire(void *ptr, void (*deleter)(void *)) {
+			Local &l = local();
+			l.retired.push_back({ ptr, deleter, 0 });
+			if (l.retired.size() >= BATCH)
+				scan(l);
+		}
+
+		template<class Node>
+		static void retire(Node *node) {
+			retire(node, [](void *ptr) { delete static_cast<Node *>(ptr); });
+		}
+	};
+};
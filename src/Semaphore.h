@@ -1,10 +1,15 @@
+#pragma once
+
 #include <assert.h>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include "Instrumentation.h"
 
 namespace semaphore {
-	class CountingSemaphore {
+	// Instrument counts and times waits, see Instrumentation.h
+	template<class Instrument = instrument::Disabled>
+	class BasicCountingSemaphore {
 	private:
 		std::mutex mtx;
 		std::condition_variable cnd;
@@ -12,11 +17,18 @@ namespace semaphore {
 	public:
 		std::atomic_uint active;
 
-		CountingSemaphore(unsigned count = 0) :
+		BasicCountingSemaphore(unsigned count = 0) :
 			count(count), active(0) {}
 
 		void acquire() {
 			std::unique_lock<decltype(mtx)> lock(mtx);
+			if (Instrument::enabled && !count) {
+				Instrument::count(instrument::SEMAPHORE_WAITS);
+				uint64_t start = instrument::nanos();
+				while (!count)
+					cnd.wait(lock);
+				Instrument::count(instrument::SEMAPHORE_WAIT_NANOS, instrument::nanos() - start);
+			}
 			while (!count)
 				cnd.wait(lock);
 			--count;
@@ -30,4 +42,6 @@ namespace semaphore {
 			cnd.notify_one();
 		}
 	};
+
+	typedef BasicCountingSemaphore<> CountingSemaphore;
 };
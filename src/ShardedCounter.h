@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include "Parallel.h"
+
+// Counters that many threads bump at once
+namespace counter {
+
+	/* Counter split into cache line sized shards
+	 *
+	 * Each thread sticks to one shard, so concurrent adds rarely share a
+	 * line. Exact sums every shard. Approximate reads a single total
+	 * instead, which a shard only catches up once it has drifted by
+	 * threshold since it last did, so once adds settle it's off by less
+	 * than threshold per shard, for good, but costs one load. Estimate
+	 * picks between them by how much that error would matter.
+	 */
+	class ShardedCounter {
+	private:
+		struct alignas(64) Shard {
+			std::atomic<long> count;
+			std::atomic<long> published; // Part of count already in total
+		};
+
+		// How many times the most the shards can hold back estimate needs
+		static const long SLACK_FACTOR = 16;
+
+		// Private member variables
+		size_t mask;
+		long threshold;
+		std::unique_ptr<Shard[]> shards;
+		alignas(64) std::atomic<long> total;
+
+		// Shard of the calling thread, threads are dealt out round robin
+		Shard &shardForThread() {
+			static std::atomic<size_t> nextThread(0);
+			static thread_local size_t thread = nextThread.fetch_add(1, std::memory_order_relaxed);
+			return shards[thread & mask];
+		}
+
+	public:
+		// A shard per thread the machine can run, rounded up to a power of two
+		ShardedCounter(long threshold = 32, size_t shardCount = parallel::defaultThreads())
+			: mask(1), threshold(threshold), total(0) {
+			while (mask < shardCount)
+				mask <<= 1;
+			shards.reset(new Shard[mask]);
+			for (size_t i = 0; i < mask; i++) {
+				shards[i].count.store(0, std::memory_order_relaxed);
+				shards[i].published.store(0, std::memory_order_relaxed);
+			}
+			mask--;
+		}
+
+		void add(long delta) {
+			Shard &shard = shardForThread();
+			long count = shard.count.fetch_add(delta, std::memory_order_relaxed) + delta;
+
+			// Drifted far enough, whoever moves published moves total with it.
+			// Losing the race means someone else published, check again
+			long published = shard.published.load(std::memory_order_relaxed);
+			while (count - published >= threshold || published - count >= threshold) {
+				if (shard.published.compare_exchange_weak(published, count, std::memory_order_relaxed)) {
+					total.fetch_add(count - published, std::memory_order_relaxed);
+					return;
+				}
+				count = shard.count.load(std::memory_order_relaxed);
+			}
+		}
+
+		void increment() { add(1); }
+		void decrement() { add(-1); }
+
+		// One load, off by less than threshold per shard
+		long approximate() const { return total.load(std::memory_order_relaxed); }
+
+		// Every add that finished before the call, and maybe some that
+		// overlap it. Reads every shard
+		long exact() const {
+			long sum = 0;
+			for (size_t i = 0; i <= mask; i++)
+				sum += shards[i].count.load();
+			return sum;
+		}
+
+		// Approximate while the total is at least 16 times what the shards
+		// can hold back, so off by less than a fifteenth once adds settle.
+		// Exact below that, so small counts are right
+		long estimate() const {
+			long approx = approximate();
+			long slack = SLACK_FACTOR * threshold * (long)shardCount();
+			if (approx >= slack || approx <= -slack)
+				return approx;
+			return exact();
+		}
+
+		// Number of shards
+		size_t shardCount() const { return mask + 1; }
+	};
+};
@@ -0,0 +1,347 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <assert.h>
+#include "Hashmap.h"
+#include "MarkableReference.h"
+#include "Reclamation.h"
+
+// Thread safe hashmap
+namespace tshm {
+
+	/* Growable hashmap over a split-ordered list
+	 *
+	 * Every entry lives in a single lock free list sorted by the bit
+	 * reversal of its hash. Buckets are just shortcuts (dummy nodes) into
+	 * that list, so doubling the bucket count never moves an entry: new
+	 * buckets are spliced in lazily the first time they are touched.
+	 * Growth is a single CAS on the bucket count, so no operation ever
+	 * waits on a resize. Removed nodes go to the Reclaimer policy.
+	 *
+	 * Operations are sequentially consistent, but behavior
+	 * between close gets and sets is not defined
+	 */
+	template<
+		class K,
+		class V,
+		class F = std::hash<K>,
+		class Reclaimer = reclaim::EpochBased
+	>
+	class SplitOrderedHashmap : IHashmap<K, V> {
+		// Less typing later
+		typedef Entry<K, V> TypedEntry;
+		typedef typename Reclaimer::Guard Guard;
+
+	private:
+		// List node, either a bucket dummy or a real entry
+		struct Node {
+			MarkableReference<Node> next;
+			size_t soKey;
+			TypedEntry entry;
+
+			Node(size_t soKey) : soKey(soKey) {} // Bucket dummy
+			Node(size_t soKey, const K &key, const V &val)
+				: soKey(soKey), entry(key, val) {}
+		};
+
+		// Buckets are stored in segments that double in size, so
+		// growing the table only ever allocates the newest segment
+		static const int MAX_SEGMENTS = 64;
+		static constexpr size_t HIGH_BIT = size_t(1) << 63;
+		static constexpr size_t MAX_BUCKETS = size_t(1) << 62;
+
+		// Hazard slots used while traversing
+		static const int SUCC_SLOT = 0, CURR_SLOT = 1, PRED_SLOT = 2;
+
+		// Private member variables
+		F hash;
+		double maxLoadFactor;
+		size_t baseSize;
+		int baseShift;
+		std::atomic<size_t> bucketCount;
+		std::atomic<size_t> curSize;
+		std::atomic<std::atomic<Node *> *> segments[MAX_SEGMENTS];
+
+		// Reverse the bits of a word
+		static size_t reverseBits(size_t x) {
+			x = ((x >> 1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) << 1);
+			x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+			x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+			return __builtin_bswap64(x);
+		}
+
+		// Real entries always have their lowest bit set,
+		// so they sort strictly after their bucket's dummy
+		static size_t regularKey(size_t hashed) { return reverseBits(hashed | HIGH_BIT); }
+		static size_t dummyKey(size_t bucket) { return reverseBits(bucket); }
+
+		// A bucket's parent is itself without its highest set bit
+		static size_t parentBucket(size_t bucket) {
+			return bucket ^ (size_t(1) << (63 - __builtin_clzll(bucket)));
+		}
+
+		// Find the slot of a bucket, allocating its segment if needed
+		std::atomic<Node *> &bucketSlot(size_t bucket) {
+			size_t high = bucket >> baseShift;
+			int seg = high == 0 ? 0 : 64 - __builtin_clzll(high);
+			size_t segStart = seg == 0 ? 0 : baseSize << (seg - 1);
+
+			std::atomic<Node *> *segment = segments[seg].load();
+			if (segment == nullptr) {
+				size_t segSize = seg == 0 ? baseSize : baseSize << (seg - 1);
+				std::atomic<Node *> *fresh = new std::atomic<Node *>[segSize]();
+				if (segments[seg].compare_exchange_strong(segment, fresh))
+					segment = fresh;
+				else
+					delete[] fresh;
+			}
+
+			return segment[bucket - segStart];
+		}
+
+		// Get the dummy node of a bucket, splicing it in if it's new
+		Node *getBucket(size_t bucket) {
+			std::atomic<Node *> &slot = bucketSlot(bucket);
+			Node *dummy = slot.load();
+			if (dummy != nullptr)
+				return dummy;
+
+			// Link a dummy after our parent's dummy.
+			// If someone beat us to it, we'll get their dummy back
+			Node *parent = getBucket(parentBucket(bucket));
+			Guard guard;
+			dummy = insert(parent, new Node(dummyKey(bucket)), true, guard);
+			slot.store(dummy);
+			return dummy;
+		}
+
+		// Does this node hold what we're looking for
+		static bool matches(Node *node, size_t soKey, const K *key) {
+			return node->soKey == soKey && (key == nullptr || node->entry.key == *key);
+		}
+
+		/*
+		 * Harris-Michael search starting from a bucket dummy.
+		 * Returns the last node before our position and the node at it,
+		 * which is either a match, the first larger node, or null.
+		 * Marked nodes we pass over are unlinked and retired.
+		 * A null key searches for a dummy.
+		 */
+		std::pair<Node *, Node *> search(Node *start, size_t soKey, const K *key, Guard &guard) {
+			Node *pred, *curr, *succ;
+			bool marked, predMarked;
+
+retry:;
+			pred = start;
+			curr = pred->next.getRef();
+			guard.protect(CURR_SLOT, curr);
+			if (pred->next.getRef() != curr)
+				goto retry;
+
+			while (curr != nullptr) {
+				succ = curr->next.getBoth(marked);
+				guard.protect(SUCC_SLOT, succ);
+
+				// Make sure succ was still linked from a live curr
+				// when we protected it, otherwise it may be freed
+				if (curr->next.getRef() != succ ||
+					pred->next.getBoth(predMarked) != curr || predMarked)
+					goto retry;
+
+				// Try to physically delete the logically deleted node
+				if (marked) {
+					Node *expectedRef = curr;
+					bool expectedMark = false;
+					if (!pred->next.compareExchangeBothWeak(
+						expectedRef,
+						expectedMark,
+						succ,
+						false
+					))
+						goto retry;
+
+					Reclaimer::retire(curr);
+				} else {
+					// Past our spot, or found it
+					if (curr->soKey > soKey || matches(curr, soKey, key))
+						break;
+
+					pred = curr;
+					guard.protect(PRED_SLOT, pred);
+				}
+
+				// Move
+				curr = succ;
+				guard.protect(CURR_SLOT, curr);
+			}
+
+			return { pred, curr };
+		}
+
+		// Link in a node after start, or return the node already there
+		Node *insert(Node *start, Node *node, bool isDummy, Guard &guard) {
+			const K *key = isDummy ? nullptr : &node->entry.key;
+			while (true) {
+				auto [ pred, curr ] = search(start, node->soKey, key, guard);
+
+				// Already there
+				if (curr != nullptr && matches(curr, node->soKey, key)) {
+					delete node;
+					return curr;
+				}
+
+				node->next = MarkableReference<Node>(curr);
+
+				Node *expectedRef = curr;
+				bool expectedMark = false;
+				if (pred->next.compareExchangeBothWeak(
+					expectedRef,
+					expectedMark,
+					node,
+					false
+				))
+					return node;
+			}
+		}
+
+		// Double the bucket count if we're past our load factor
+		void maybeGrow(size_t items) {
+			size_t buckets = bucketCount.load();
+			if (items > maxLoadFactor * buckets && buckets < MAX_BUCKETS)
+				bucketCount.compare_exchange_strong(buckets, buckets * 2);
+		}
+
+	public:
+		// Construct hashmap, capacity is rounded up to a power of two
+		SplitOrderedHashmap(uint capacity = 16, double maxLoadFactor = 2.0)
+			: maxLoadFactor(maxLoadFactor), baseSize(1), baseShift(0),
+			curSize(0) {
+			assert(maxLoadFactor > 0 && "load factor must be positive");
+
+			while (baseSize < capacity) {
+				baseSize <<= 1;
+				baseShift++;
+			}
+			bucketCount = baseSize;
+
+			for (auto &segment : segments)
+				segment = nullptr;
+
+			// Bucket zero's dummy is the head of the whole list
+			bucketSlot(0).store(new Node(dummyKey(0)));
+		}
+
+		// Free the list and the bucket table
+		virtual ~SplitOrderedHashmap() {
+			Node *curr = bucketSlot(0).load();
+			while (curr != nullptr) {
+				Node *next = curr->next.getRef();
+				delete curr;
+				curr = next;
+			}
+
+			for (auto &segment : segments)
+				delete[] segment.load();
+		}
+
+		// Associate specified key with specified value
+		void put(const K &key, const V &val) {
+			size_t hashed = hash(key);
+			size_t soKey = regularKey(hashed);
+			Node *bucket = getBucket(hashed & (bucketCount.load() - 1));
+			Guard guard;
+
+			Node *node = nullptr;
+			while (true) {
+				auto [ pred, curr ] = search(bucket, soKey, &key, guard);
+
+				// Found it, update
+				if (curr != nullptr && matches(curr, soKey, &key)) {
+					curr->entry.val.store(val);
+					delete node;
+					return;
+				}
+
+				if (node == nullptr)
+					node = new Node(soKey, key, val);
+				node->next = MarkableReference<Node>(curr);
+
+				Node *expectedRef = curr;
+				bool expectedMark = false;
+				if (pred->next.compareExchangeBothWeak(
+					expectedRef,
+					expectedMark,
+					node,
+					false
+				)) {
+					maybeGrow(++curSize);
+					return;
+				}
+			}
+		}
+
+		// Return the status of containment and value
+		std::pair<bool, V> get(const K &key) {
+			size_t hashed = hash(key);
+			size_t soKey = regularKey(hashed);
+			Node *bucket = getBucket(hashed & (bucketCount.load() - 1));
+			Guard guard;
+
+			auto [ pred, curr ] = search(bucket, soKey, &key, guard);
+			if (curr != nullptr && matches(curr, soKey, &key) && !curr->next.getMark())
+				return {true, curr->entry.val.load()};
+
+			return {false, V{}};
+		}
+
+		// Remove a key from the map
+		bool remove(const K &key) {
+			size_t hashed = hash(key);
+			size_t soKey = regularKey(hashed);
+			Node *bucket = getBucket(hashed & (bucketCount.load() - 1));
+			Guard guard;
+
+			while (true) {
+				auto [ pred, curr ] = search(bucket, soKey, &key, guard);
+
+				// We didn't find it, stop
+				if (curr == nullptr || !matches(curr, soKey, &key))
+					return false;
+
+				// Logically delete node by marking it's successor
+				Node *succ = curr->next.getRef();
+				Node *expectedRef = succ;
+				bool expectedMark = false;
+				if (!curr->next.compareExchangeBothWeak(
+					expectedRef,
+					expectedMark,
+					succ,
+					true
+				))
+					continue;
+
+				curSize--;
+
+				// Attempt physical, search will clean up if this fails
+				expectedRef = curr;
+				expectedMark = false;
+				if (pred->next.compareExchangeBothWeak(
+					expectedRef,
+					expectedMark,
+					succ,
+					false
+				))
+					Reclaimer::retire(curr);
+
+				return true;
+			}
+		}
+
+		// Get current number of entries
+		size_t size() { return curSize; }
+
+		// Get current number of buckets
+		size_t buckets() { return bucketCount; }
+	};
+};
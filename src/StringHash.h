@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <functional>
+#include <cstdint>
+
+namespace tshm {
+
+	// Spread the bits of a hash, std::hash is often the identity
+	inline uint64_t mix64(uint64_t x) {
+		x ^= x >> 30;
+		x *= 0xbf58476d1ce4e5b9ULL;
+		x ^= x >> 27;
+		x *= 0x94d049bb133111ebULL;
+		x ^= x >> 31;
+		return x;
+	}
+
+	/* Transparent string hash
+	 *
+	 * Hashes std::string, std::string_view and C strings identically,
+	 * so maps and sets keyed on std::string can be probed with any of
+	 * them without building a temporary std::string first.
+	 */
+	struct StringHash {
+		typedef void is_transparent;
+
+		size_t operator()(std::string_view str) const {
+			return std::hash<std::string_view>()(str);
+		}
+		size_t operator()(const std::string &str) const {
+			return (*this)(std::string_view(str));
+		}
+		size_t operator()(const char *str) const {
+			return (*this)(std::string_view(str));
+		}
+	};
+};
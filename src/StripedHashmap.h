@@ -0,0 +1,186 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <shared_mutex>
+#include <mutex>
+#include <utility>
+#include "Hashmap.h"
+#include "Parallel.h"
+
+// Thread safe hashmap
+namespace tshm {
+
+	/* Hashmap guarded by a small array of reader-writer lock stripes
+	 *
+	 * Bucket i belongs to stripe i % stripes. Readers take their stripe
+	 * shared, so lookups run in parallel, and writers take it exclusive.
+	 * Nodes are just key, value and next, as the stripe does all the
+	 * locking. Stripes are padded to a cache line each, so pick a
+	 * count a few times the number of cores rather than one per bucket.
+	 * Alloc picks how nodes are allocated.
+	 */
+	template<
+		class K,
+		class V,
+		class F = std::hash<K>,
+		class Alloc = alloc::HeapAllocator
+	>
+	class StripedHashmap : IHashmap<K, V> {
+	private:
+		struct Node {
+			Node *next;
+			K key;
+			V val;
+
+			template<class KArg, class... VArgs>
+			Node(Node *next, KArg &&key, VArgs&&... args)
+				: next(next), key(std::forward<KArg>(key)), val(std::forward<VArgs>(args)...) {}
+		};
+
+		struct alignas(64) Stripe {
+			std::shared_mutex mtx;
+		};
+
+		// Private member variables
+		uint capacity;
+		uint numStripes;
+		F hash;
+		std::vector<Node *> buckets;
+		std::unique_ptr<Stripe[]> stripes;
+		std::atomic<size_t> curSize;
+
+		// Where a key lives, and the stripe that guards it
+		size_t getIndex(const K &key) const {
+			return hash(key) % capacity;
+		}
+		std::shared_mutex &stripeFor(size_t index) {
+			return stripes[index % numStripes].mtx;
+		}
+
+		// Node holding key in a bucket, null if there is none. Stripe must be held
+		static Node *findNode(Node *curr, const K &key) {
+			while (curr != nullptr && !(curr->key == key))
+				curr = curr->next;
+			return curr;
+		}
+
+	public:
+		// Four stripes per core unless told otherwise
+		static uint defaultStripes() { return parallel::defaultThreads() * 4; }
+
+		// Construct hashmap
+		StripedHashmap(uint capacity, uint stripes = defaultStripes())
+			: capacity(capacity), numStripes(std::max(stripes, 1u)),
+			buckets(capacity, nullptr), stripes(new Stripe[numStripes]), curSize(0) {}
+
+		// Free every node, not thread safe
+		virtual ~StripedHashmap() {
+			for (Node *curr : buckets) {
+				while (curr != nullptr) {
+					Node *next = curr->next;
+					Alloc::destroy(curr);
+					curr = next;
+				}
+			}
+		}
+
+		// Associate specified key with specified value
+		void put(const K &key, const V &val) {
+			size_t index = getIndex(key);
+			std::unique_lock<std::shared_mutex> lock(stripeFor(index));
+
+			Node *node = findNode(buckets[index], key);
+			if (node != nullptr) {
+				node->val = val;
+				return;
+			}
+			buckets[index] = Alloc::template create<Node>(buckets[index], key, val);
+			curSize++;
+		}
+
+		/*
+		 * Build the value from args in a new node, only if key is missing.
+		 * Returns whether we added it.
+		 */
+		template<class... Args>
+		bool try_emplace(const K &key, Args&&... args) {
+			size_t index = getIndex(key);
+			std::unique_lock<std::shared_mutex> lock(stripeFor(index));
+
+			if (findNode(buckets[index], key) != nullptr)
+				return false;
+			buckets[index] = Alloc::template create<Node>(buckets[index], key, std::forward<Args>(args)...);
+			curSize++;
+			return true;
+		}
+
+		/*
+		 * Replace the value for key with fn(current), current being V{}
+		 * if key is missing. Fn runs once, under the stripe's lock.
+		 * Returns the value we stored.
+		 */
+		template<class Fn>
+		V compute(const K &key, Fn &&fn) {
+			size_t index = getIndex(key);
+			std::unique_lock<std::shared_mutex> lock(stripeFor(index));
+
+			Node *node = findNode(buckets[index], key);
+			if (node != nullptr)
+				return node->val = fn(static_cast<const V &>(node->val));
+			buckets[index] = Alloc::template create<Node>(buckets[index], key, fn(V{}));
+			curSize++;
+			return buckets[index]->val;
+		}
+
+		// Return the status of containment and value
+		std::pair<bool, V> get(const K &key) {
+			std::pair<bool, V> result = {false, V{}};
+			visit(key, [&result](const V &val) {
+				result = {true, val};
+			});
+			return result;
+		}
+
+		/*
+		 * Hand the value stored for key to fn in place, under the stripe's
+		 * shared lock. Fn must not call back into this map.
+		 * Returns whether the key was there.
+		 */
+		template<class Fn>
+		bool visit(const K &key, Fn &&fn) {
+			size_t index = getIndex(key);
+			std::shared_lock<std::shared_mutex> lock(stripeFor(index));
+
+			Node *node = findNode(buckets[index], key);
+			if (node == nullptr)
+				return false;
+			fn(static_cast<const V &>(node->val));
+			return true;
+		}
+
+		// Remove a key from the map
+		bool remove(const K &key) {
+			size_t index = getIndex(key);
+			std::unique_lock<std::shared_mutex> lock(stripeFor(index));
+
+			for (Node **link = &buckets[index]; *link != nullptr; link = &(*link)->next) {
+				if ((*link)->key == key) {
+					Node *node = *link;
+					*link = node->next;
+					Alloc::destroy(node);
+					curSize--;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// Get current number of entries
+		size_t size() { return curSize; }
+
+		// Get the number of lock stripes
+		uint stripeCount() { return numStripes; }
+	};
+};
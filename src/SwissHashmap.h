@@ -0,0 +1,342 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <cstdint>
+#include "Hashmap.h"
+#include "StringHash.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Thread safe hashmap
+namespace tshm {
+
+	/* Open addressing hashmap probing 16 slot groups at a time
+	 *
+	 * Every group keeps a one byte tag per slot, seven bits of the key's
+	 * hash or EMPTY, so a lookup compares all 16 tags in one SSE2
+	 * instruction and only looks at keys whose tag matched. Probing moves
+	 * a group at a time and stops at the first group with an empty slot.
+	 *
+	 * Like FlatHashmap, removal just clears a slot's live bit, so probe
+	 * chains never break, and the next key added along that chain takes
+	 * the dead slot over. New keys are added under a stripe lock picked by
+	 * their home group, so two threads can't add the same key twice.
+	 * Each group has a version that doubles as its writer lock: writers
+	 * take it odd with a CAS and bump it back to even, and readers go
+	 * through the group optimistically and retry if it moved.
+	 * That requires the value type to be trivially copyable, and keys
+	 * that aren't are compared with the group held instead.
+	 *
+	 * The table does not grow; put throws std::length_error
+	 * once every slot holds a live key.
+	 */
+	template<
+		class K,
+		class V,
+		class F = std::hash<K>
+	>
+	class SwissHashmap : IHashmap<K, V> {
+		static_assert(
+			std::is_trivially_copyable<V>::value,
+			"SwissHashmap values are read optimistically and must be trivially copyable"
+		);
+		static_assert(sizeof(std::atomic<uint8_t>) == 1, "Tags are loaded 16 at a time");
+
+	private:
+		static const int SLOTS = 16;
+		static const uint8_t EMPTY = 0x80; // High bit set, claimed tags never have it
+		static const uint32_t ALL_SLOTS = (1u << SLOTS) - 1;
+
+		// Whether keys can be copied while a writer changes them
+		static const bool OPTIMISTIC_KEYS = std::is_trivially_copyable<K>::value;
+
+		// Key next to its value, so a hit touches one more line at most
+		struct Slot {
+			K key; // Only changes with the group held
+			V val;
+		};
+
+		struct alignas(64) Group {
+			std::atomic<uint32_t> version; // Odd while a writer holds the group
+			std::atomic<uint16_t> live;    // Bit per slot whose value is present
+			std::atomic<uint8_t> tags[SLOTS];
+			Slot slots[SLOTS];
+
+			Group() : version(0), live(0) {
+				for (int i = 0; i < SLOTS; i++)
+					tags[i].store(EMPTY, std::memory_order_relaxed);
+			}
+		};
+
+		struct alignas(64) Stripe {
+			std::mutex mtx;
+		};
+
+		// Private member variables
+		size_t groupCount;
+		size_t mask;
+		F hash;
+		std::unique_ptr<Group[]> groups;
+		size_t stripeMask;
+		std::unique_ptr<Stripe[]> stripes;
+		std::atomic<size_t> curSize;
+
+		// Bit per slot whose tag is tag. Racy, callers validate
+		static uint32_t match(const Group &group, uint8_t tag) {
+#ifdef __SSE2__
+			__m128i tags = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group.tags));
+			return _mm_movemask_epi8(_mm_cmpeq_epi8(tags, _mm_set1_epi8((char)tag)));
+#else
+			uint32_t bits = 0;
+			for (int i = 0; i < SLOTS; i++)
+				if (group.tags[i].load(std::memory_order_relaxed) == tag)
+					bits |= 1u << i;
+			return bits;
+#endif
+		}
+
+		// Bit per empty slot, EMPTY is the only tag with its high bit set
+		static uint32_t matchEmpty(const Group &group) {
+#ifdef __SSE2__
+			return _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(group.tags)));
+#else
+			return match(group, EMPTY);
+#endif
+		}
+
+		// Take a group's version odd, returning the even one we started from
+		static uint32_t lock(Group &group) {
+			uint32_t version = group.version.load(std::memory_order_relaxed);
+			while (true) {
+				if (version & 1) {
+					std::this_thread::yield();
+					version = group.version.load(std::memory_order_relaxed);
+					continue;
+				}
+				if (group.version.compare_exchange_weak(
+					version,
+					version + 1,
+					std::memory_order_acquire
+				)) {
+					// Readers that see any of our writes must see us holding it
+					std::atomic_thread_fence(std::memory_order_release);
+					return version;
+				}
+			}
+		}
+
+		// Publish a new version, or put the old one back if nothing changed
+		static void unlock(Group &group, uint32_t version, bool changed) {
+			group.version.store(changed ? version + 2 : version, std::memory_order_release);
+		}
+
+		// Where to look first, and the tag to look for
+		void locate(const K &key, size_t &index, uint8_t &tag) const {
+			uint64_t h = mix64(hash(key));
+			tag = h & 0x7f;
+			index = (h >> 7) & mask;
+		}
+
+		// Slot in a group holding key live, or -1. Racy unless the group is held
+		static int findLive(const Group &group, uint8_t tag, const K &key, uint16_t live) {
+			for (uint32_t bits = match(group, tag) & live; bits != 0; bits &= bits - 1) {
+				int slot = __builtin_ctz(bits);
+				if (group.slots[slot].key == key)
+					return slot;
+			}
+			return -1;
+		}
+
+		// Give key a slot that isn't live, dead ones first so empty ones
+		// keep ending probes. Group must be held
+		static void claim(Group &group, uint16_t live, const K &key, const V &val, uint8_t tag) {
+			uint32_t empty = matchEmpty(group);
+			uint32_t dead = ~(uint32_t)live & ~empty & ALL_SLOTS;
+			int slot = __builtin_ctz(dead != 0 ? dead : empty);
+			group.slots[slot].key = key;
+			group.slots[slot].val = val;
+			group.tags[slot].store(tag, std::memory_order_release);
+			group.live.store(live | 1 << slot, std::memory_order_relaxed);
+		}
+
+		/*
+		 * Overwrite key's value if it's live. Otherwise, if add is set, which
+		 * needs the key's stripe held, give it the first slot along its probe
+		 * that isn't live. Returns whether either happened, so false with add
+		 * set means that slot was taken before we got back to it.
+		 */
+		bool update(const K &key, const V &val, size_t index, uint8_t tag, bool add) {
+			Group *free = nullptr;
+			for (size_t step = 1; step <= groupCount; index = (index + step++) & mask) {
+				Group &group = groups[index];
+				uint32_t version = lock(group);
+				uint16_t live = group.live.load(std::memory_order_relaxed);
+
+				// Our slot, overwrite the value
+				int slot = findLive(group, tag, key, live);
+				if (slot >= 0) {
+					group.slots[slot].val = val;
+					unlock(group, version, true);
+					return true;
+				}
+
+				// An empty slot means nothing further along, so take this
+				// group if we haven't passed a dead slot already
+				bool hasEmpty = matchEmpty(group) != 0;
+				if (add && free == nullptr && live != ALL_SLOTS) {
+					if (hasEmpty) {
+						claim(group, live, key, val, tag);
+						unlock(group, version, true);
+						curSize++;
+						return true;
+					}
+					free = &group;
+				}
+
+				unlock(group, version, false);
+				if (hasEmpty)
+					break;
+			}
+
+			if (!add)
+				return false;
+			if (free == nullptr)
+				throw std::length_error("SwissHashmap is full");
+
+			// Go back to the first group with a dead slot
+			uint32_t version = lock(*free);
+			uint16_t live = free->live.load(std::memory_order_relaxed);
+			bool taken = live == ALL_SLOTS;
+			if (!taken) {
+				claim(*free, live, key, val, tag);
+				curSize++;
+			}
+			unlock(*free, version, !taken);
+			return !taken;
+		}
+
+	public:
+		// Construct hashmap, rounded up to a power of two groups,
+		// and so is the stripe count of four per core
+		SwissHashmap(uint capacity) : groupCount(1), stripeMask(1), curSize(0) {
+			while (groupCount * SLOTS < capacity)
+				groupCount <<= 1;
+			mask = groupCount - 1;
+			groups.reset(new Group[groupCount]);
+
+			while (stripeMask < parallel::defaultThreads() * 4)
+				stripeMask <<= 1;
+			stripes.reset(new Stripe[stripeMask]);
+			stripeMask--;
+		}
+
+		// Nothing really interesting about the destructor
+		virtual ~SwissHashmap() {}
+
+		// Associate specified key with specified value
+		void put(const K &key, const V &val) {
+			size_t index;
+			uint8_t tag;
+			locate(key, index, tag);
+
+			// Already there, just overwrite the value
+			if (update(key, val, index, tag, false))
+				return;
+
+			// Nobody else adds our key while we hold its stripe,
+			// so a miss under it stays a miss until we add it
+			std::lock_guard<std::mutex> guard(stripes[index & stripeMask].mtx);
+			while (!update(key, val, index, tag, true)) {}
+		}
+
+		// Return the status of containment and value
+		std::pair<bool, V> get(const K &key) {
+			size_t index;
+			uint8_t tag;
+			locate(key, index, tag);
+
+			for (size_t step = 1; step <= groupCount; index = (index + step++) & mask) {
+				Group &group = groups[index];
+				int found;
+				V val{};
+				bool hasEmpty;
+
+				if constexpr (OPTIMISTIC_KEYS) {
+					// Optimistic read, retry if a writer got in our way
+					while (true) {
+						uint32_t before = group.version.load(std::memory_order_acquire);
+						if (before & 1) {
+							std::this_thread::yield();
+							continue;
+						}
+
+						found = findLive(group, tag, key, group.live.load(std::memory_order_relaxed));
+						if (found >= 0)
+							val = group.slots[found].val;
+						hasEmpty = matchEmpty(group) != 0;
+
+						std::atomic_thread_fence(std::memory_order_acquire);
+						if (group.version.load(std::memory_order_relaxed) == before)
+							break;
+					}
+				} else {
+					uint32_t version = lock(group);
+					found = findLive(group, tag, key, group.live.load(std::memory_order_relaxed));
+					if (found >= 0)
+						val = group.slots[found].val;
+					hasEmpty = matchEmpty(group) != 0;
+					unlock(group, version, false);
+				}
+
+				if (found >= 0)
+					return {true, val};
+				if (hasEmpty)
+					break;
+			}
+
+			return {false, V{}};
+		}
+
+		// Remove a key from the map
+		bool remove(const K &key) {
+			size_t index;
+			uint8_t tag;
+			locate(key, index, tag);
+
+			for (size_t step = 1; step <= groupCount; index = (index + step++) & mask) {
+				Group &group = groups[index];
+				uint32_t version = lock(group);
+				uint16_t live = group.live.load(std::memory_order_relaxed);
+
+				int slot = findLive(group, tag, key, live);
+				if (slot >= 0) {
+					group.live.store(live & ~(1 << slot), std::memory_order_relaxed);
+					unlock(group, version, true);
+					curSize--;
+					return true;
+				}
+
+				// An empty slot means the key isn't further along
+				bool hasEmpty = matchEmpty(group) != 0;
+				unlock(group, version, false);
+				if (hasEmpty)
+					return false;
+			}
+
+			return false;
+		}
+
+		// Get current number of entries
+		size_t size() { return curSize; }
+
+		// Get the number of slots
+		size_t slotCount() { return groupCount * SLOTS; }
+	};
+};
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <cstdint>
+#include <type_traits>
+
+namespace tshm {
+
+	// Whether a value fits in a lock free std::atomic
+	template<class V, bool = std::is_trivially_copyable_v<V> && sizeof(V) <= sizeof(uint64_t)>
+	struct isAtomicValue : std::false_type {};
+
+	template<class V>
+	struct isAtomicValue<V, true> : std::bool_constant<std::atomic<V>::is_always_lock_free> {};
+
+	/* Value storage for a map entry
+	 *
+	 * Lets readers and writers share a value without ever seeing it torn,
+	 * and lets concurrent updates land without losing any. Small trivially
+	 * copyable values live in a std::atomic, everything else sits behind
+	 * a spinlock that is only held while the value is copied or updated.
+	 */
+	template<class V, bool Atomic = isAtomicValue<V>::value>
+	class ValueCell {
+	private:
+		mutable std::atomic<bool> locked;
+		V value;
+
+		void lock() const {
+			while (locked.exchange(true, std::memory_order_acquire))
+				while (locked.load(std::memory_order_relaxed))
+					std::this_thread::yield();
+		}
+		void unlock() const { locked.store(false, std::memory_order_release); }
+
+	public:
+		ValueCell() : locked(false), value() {}
+		template<class... Args>
+		ValueCell(std::in_place_t, Args&&... args)
+			: locked(false), value(std::forward<Args>(args)...) {}
+		ValueCell(const ValueCell &other) : locked(false), value(other.load()) {}
+		ValueCell(ValueCell &&other) : locked(false), value(std::move(other.value)) {}
+
+		ValueCell &operator=(const ValueCell &other) {
+			store(other.load());
+			return *this;
+		}
+		ValueCell &operator=(ValueCell &&other) {
+			store(std::move(other.value));
+			return *this;
+		}
+
+		// Copy of the current value
+		V load() const {
+			lock();
+			V copy = value;
+			unlock();
+			return copy;
+		}
+
+		// Hand the current value to fn in place, fn must be quick
+		template<class Fn>
+		void read(Fn &&fn) const {
+			lock();
+			fn(static_cast<const V &>(value));
+			unlock();
+		}
+
+		template<class U>
+		void store(U &&val) {
+			lock();
+			value = std::forward<U>(val);
+			unlock();
+		}
+
+		// Replace the value with fn(value), return the new value
+		template<class Fn>
+		V update(Fn &&fn) {
+			lock();
+			value = fn(static_cast<const V &>(value));
+			V copy = value;
+			unlock();
+			return copy;
+		}
+
+		// Swap in val, return the old value
+		template<class U>
+		V exchange(U &&val) {
+			lock();
+			V old = std::move(value);
+			value = std::forward<U>(val);
+			unlock();
+			return old;
+		}
+
+		/*
+		 * Swap in desired if the value equals expected, like std::atomic.
+		 * On failure expected gets the value we saw instead.
+		 */
+		bool compareExchange(V &expected, const V &desired) {
+			lock();
+			bool swapped = value == expected;
+			if (swapped)
+				value = desired;
+			else
+				expected = value;
+			unlock();
+			return swapped;
+		}
+
+		// Add delta, return the old value
+		V fetchAdd(const V &delta) {
+			lock();
+			V old = value;
+			value = value + delta;
+			unlock();
+			return old;
+		}
+
+		// The value itself, only for cells no other thread can see yet
+		V &NOT_THREAD_SAFE_get() { return value; }
+	};
+
+	// Lock free cell for small values
+	template<class V>
+	class ValueCell<V, true> {
+	private:
+		std::atomic<V> value;
+
+	public:
+		ValueCell() : value(V()) {}
+		template<class... Args>
+		ValueCell(std::in_place_t, Args&&... args) : value(V(std::forward<Args>(args)...)) {}
+		ValueCell(const ValueCell &other) : value(other.load()) {}
+
+		ValueCell &operator=(const ValueCell &other) {
+			store(other.load());
+			return *this;
+		}
+
+		V load() const { return value.load(); }
+
+		// Fn gets a snapshot, the value may have moved on by the time it runs
+		template<class Fn>
+		void read(Fn &&fn) const {
+			V copy = value.load();
+			fn(static_cast<const V &>(copy));
+		}
+
+		void store(const V &val) { value.store(val); }
+
+		// Replace the value with fn(value), fn may run more than once
+		template<class Fn>
+		V update(Fn &&fn) {
+			V old = value.load(), desired;
+			do {
+				desired = fn(static_cast<const V &>(old));
+			} while (!value.compare_exchange_weak(old, desired));
+			return desired;
+		}
+
+		V exchange(const V &val) { return value.exchange(val); }
+
+		// Compares with ==, not bit for bit like std::atomic does
+		bool compareExchange(V &expected, const V &desired) {
+			V current = value.load();
+			while (true) {
+				if (!(current == expected)) {
+					expected = current;
+					return false;
+				}
+				if (value.compare_exchange_weak(current, desired))
+					return true;
+			}
+		}
+
+		V fetchAdd(const V &delta) {
+			if constexpr (std::is_integral_v<V> && !std::is_same_v<V, bool>) {
+				return value.fetch_add(delta);
+			} else {
+				V old = value.load();
+				while (!value.compare_exchange_weak(old, old + delta));
+				return old;
+			}
+		}
+
+		// Nobody else can see it, but an atomic is still the safe way in
+		V NOT_THREAD_SAFE_get() const { return value.load(std::memory_order_relaxed); }
+	};
+};
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+namespace queue {
+
+	/* Bounded lock free multi-producer multi-consumer queue
+	 *
+	 * Ring of cells, each with a sequence number that says whether it is
+	 * ready to be written or read for the current lap (Vyukov's design).
+	 * Producers and consumers each claim positions with a CAS on their
+	 * own counter, so they never contend with each other.
+	 */
+	template<class T>
+	class MPMCQueue {
+	private:
+		struct Cell {
+			std::atomic<size_t> sequence;
+			T data;
+		};
+
+		// Private member variables
+		size_t mask;
+		std::unique_ptr<Cell[]> cells;
+		alignas(64) std::atomic<size_t> enqueuePos;
+		alignas(64) std::atomic<size_t> dequeuePos;
+
+		// Claim a position to write, or null if we're full
+		Cell *claimPush(size_t &pos) {
+			pos = enqueuePos.load(std::memory_order_relaxed);
+			while (true) {
+				Cell *cell = &cells[pos & mask];
+				size_t seq = cell->sequence.load(std::memory_order_acquire);
+				intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+
+				if (dif == 0) {
+					if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+						return cell;
+				} else if (dif < 0) {
+					return nullptr;
+				} else {
+					pos = enqueuePos.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+	public:
+		// Construct, capacity is rounded up to a power of two
+		MPMCQueue(size_t capacity) : enqueuePos(0), dequeuePos(0) {
+			size_t size = 2;
+			while (size < capacity)
+				size <<= 1;
+			mask = size - 1;
+
+			cells.reset(new Cell[size]);
+			for (size_t i = 0; i < size; i++)
+				cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+
+		// Push an item, false if the queue is full
+		bool tryPush(const T &val) {
+			size_t pos;
+			Cell *cell = claimPush(pos);
+			if (cell == nullptr)
+				return false;
+
+			cell->data = val;
+			cell->sequence.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool tryPush(T &&val) {
+			size_t pos;
+			Cell *cell = claimPush(pos);
+			if (cell == nullptr)
+				return false;
+
+			cell->data = std::move(val);
+			cell->sequence.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		/*
+		 * Pop up to max consecutive ready items with a single claim.
+		 * Returns how many were popped, zero if nothing was ready.
+		 * If first is given it gets the queue position of out[0], and
+		 * out[i] sits at position *first + i.
+		 */
+		size_t tryPopBatch(T *out, size_t max, size_t *first = nullptr) {
+			size_t pos = dequeuePos.load(std::memory_order_relaxed);
+			size_t count;
+
+			while (true) {
+				// Count how many cells in a row are ready for us
+				count = 0;
+				while (count < max) {
+					Cell *cell = &cells[(pos + count) & mask];
+					size_t seq = cell->sequence.load(std::memory_order_acquire);
+					if (seq != pos + count + 1)
+						break;
+					count++;
+				}
+
+				if (count == 0) {
+					// Either empty, or we're behind and need a fresh position
+					Cell *cell = &cells[pos & mask];
+					intptr_t dif = (intptr_t)cell->sequence.load(std::memory_order_acquire) - (intptr_t)(pos + 1);
+					if (dif < 0)
+						return 0;
+					pos = dequeuePos.load(std::memory_order_relaxed);
+					continue;
+				}
+
+				// Sequentially consistent so anything a consumer published
+				// before claiming is visible to whoever claims after it
+				if (dequeuePos.compare_exchange_weak(pos, pos + count))
+					break;
+			}
+
+			// Read everything out and free the cells for the next lap
+			for (size_t i = 0; i < count; i++) {
+				Cell *cell = &cells[(pos + i) & mask];
+				out[i] = std::move(cell->data);
+				cell->sequence.store(pos + i + mask + 1, std::memory_order_release);
+			}
+
+			if (first != nullptr)
+				*first = pos;
+			return count;
+		}
+
+		// Pop a single item, false if nothing was ready
+		bool tryPop(T &out) {
+			return tryPopBatch(&out, 1) == 1;
+		}
+
+		// Whether anything has been pushed but not yet popped
+		bool empty() {
+			return enqueuePos.load() == dequeuePos.load();
+		}
+
+		// Position the next pop will start from, never more than
+		// the position anything popped afterwards gets
+		size_t nextPopPosition() {
+			return dequeuePos.load();
+		}
+
+		size_t capacity() { return mask + 1; }
+	};
+};
@@ -10,6 +10,7 @@ using std::thread;
 using std::cout;
 
 using ll::AddOnlyLockFreeLL;
+using ll::SortedAddOnlyLockFreeLL;
 
 int main() {
 	cout << "\n\nADD ONLY LOCK FREE LINKED LIST TESTING...\n\n";
@@ -21,6 +22,9 @@ int main() {
 	cout << "Testing sequential add...\n";
 	AddOnlyLockFreeLL<int> sequentialList;
 	assert(sequentialList.size() == 0);
+	int missing = 0;
+	assert(!sequentialList.find(missing));
+	assert(sequentialList.NOT_THREAD_SAFE_getHead() == nullptr);
 	for (int x = 0; x < 10; x++)
 		sequentialList.add(x);
 	assert(sequentialList.size() == 10);
@@ -76,6 +80,39 @@ int main() {
 		t.join();
 	jobs.clear();
 
+	/*
+	 * SORTED TESTING
+	 */
+	cout << "\nBEGINNING SORTED CHECKS\n";
+	cout << "-----------------------\n";
+	cout << "Testing sorted add and misses...\n";
+	SortedAddOnlyLockFreeLL<int> sortedList;
+	for (int thread = 0; thread < THREADS; thread++)
+		jobs.emplace_back([&sortedList](int start) {
+			for (int x = start; x < LIM; x += THREADS) {
+				sortedList.add(x * 3);
+				sortedList.add(x * 3);
+			}
+		}, thread);
+	for (thread &t : jobs)
+		t.join();
+	jobs.clear();
+	assert(sortedList.size() == LIM);
+	for (int x = 0; x < 3 * LIM; x++) {
+		int search = x;
+		bool found = sortedList.find(search);
+		assert(found == (x % 3 == 0));
+	}
+
+	cout << "Checking hash order...\n";
+	auto *sortedCurr = sortedList.NOT_THREAD_SAFE_getHead()->next.load();
+	size_t lastHash = 0;
+	while (sortedCurr != nullptr) {
+		assert(sortedCurr->hash >= lastHash);
+		lastHash = sortedCurr->hash;
+		sortedCurr = sortedCurr->next;
+	}
+
 	cout << "\nSuccess :D\n";
 	return 0;
 }
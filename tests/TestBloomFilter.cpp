@@ -0,0 +1,77 @@
+#include <assert.h>
+#include <vector>
+#include <thread>
+#include <string>
+#include <iostream>
+#include "../src/BloomFilter.h"
+#include "../src/Hashmap.h"
+#include "../src/Hashset.h"
+
+using std::vector;
+using std::thread;
+using std::string;
+using std::cout;
+
+using bloom::BlockedBloomFilter;
+using tshm::Hashmap;
+using tshs::Hashset;
+
+int main() {
+	cout << "\n\nBLOOM FILTER TESTING...\n\n";
+
+	const int THREADS = 8, LIM = 100'000;
+	cout << "Testing threaded inserts...\n";
+	BlockedBloomFilter filter(LIM, 10);
+	assert(filter.bytes() >= LIM * 10 / 8);
+	vector<thread> jobs;
+	for (int t = 0; t < THREADS; t++) {
+		jobs.emplace_back([&, t] {
+			for (int x = t; x < LIM; x += THREADS)
+				filter.insert(std::hash<int>()(x));
+		});
+	}
+	for (thread &t : jobs)
+		t.join();
+	jobs.clear();
+
+	cout << "Checking for false negatives...\n";
+	for (int x = 0; x < LIM; x++)
+		assert(filter.mayContain(std::hash<int>()(x)));
+
+	cout << "Checking the false positive rate...\n";
+	int falsePositives = 0;
+	for (int x = LIM; x < 2 * LIM; x++)
+		falsePositives += filter.mayContain(std::hash<int>()(x));
+	cout << "False positives: " << falsePositives * 100.0 / LIM << "%\n";
+	assert(falsePositives < LIM / 50);
+
+	cout << "Testing filtered hashmap...\n";
+	Hashmap<string, int> hashmap(1'000, 10);
+	for (int t = 0; t < THREADS; t++) {
+		jobs.emplace_back([&, t] {
+			for (int x = t; x < 1'000; x += THREADS)
+				hashmap.put(std::to_string(x), x);
+			for (int x = t; x < 1'000; x += THREADS)
+				assert(hashmap.fetchAdd(std::to_string(x + 1'000), 1) == 0);
+		});
+	}
+	for (thread &t : jobs)
+		t.join();
+	jobs.clear();
+	for (int x = 0; x < 3'000; x++) {
+		auto [contained, value] = hashmap.get(std::to_string(x));
+		assert(contained == (x < 2'000) && value == (x < 1'000 ? x : x < 2'000));
+	}
+
+	cout << "Testing filtered hashset...\n";
+	Hashset<int, ll::LockFreeLL> hashset(1'000, 10);
+	for (int x = 0; x < 1'000; x++)
+		assert(hashset.insert(x * 2));
+	for (int x = 0; x < 2'000; x++)
+		assert(hashset.contains(x) == (x % 2 == 0));
+	assert(hashset.erase(0) && !hashset.contains(0) && !hashset.erase(1));
+	assert(hashset.insert(0) && hashset.contains(0));
+
+	cout << "\nSuccess :D\n";
+	return 0;
+}
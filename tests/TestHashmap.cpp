@@ -5,6 +5,10 @@
 #include <set>
 #include <vector>
 #include <thread>
+#include <string_view>
+#include <atomic>
+#include <iterator>
+#include <algorithm>
 #include "../src/Hashmap.h"
 
 using std::cout;
@@ -15,6 +19,147 @@ using std::thread;
 
 using tshm::Hashmap;
 
+// Value that counts how often it gets copied
+struct Counted {
+	static std::atomic<int> copies;
+	int val;
+	Counted(int val = 0) : val(val) {}
+	Counted(const Counted &other) : val(other.val) { copies++; }
+	Counted(Counted &&other) = default;
+	Counted &operator=(const Counted &other) { val = other.val; copies++; return *this; }
+	Counted &operator=(Counted &&other) = default;
+};
+std::atomic<int> Counted::copies(0);
+
+// Moved and emplaced values should never be copied on the way in
+template<template<class> class Container>
+void checkNoCopies() {
+	Hashmap<int, Counted, Container> counted(100);
+	Counted::copies = 0;
+	for (int i = 0; i < 1'000; i++)
+		counted.put(i * 3, Counted(i));
+	for (int i = 0; i < 1'000; i++)
+		assert(counted.try_emplace(i * 3 + 1, i));
+	for (int i = 0; i < 1'000; i++)
+		assert(counted.emplace(i * 3 + 2, i));
+	assert(Counted::copies == 0);
+
+	// Existing keys are left alone
+	assert(!counted.try_emplace(0, -1));
+	assert(!counted.emplace(1, -1));
+	for (int i = 0; i < 3'000; i++) {
+		auto [contained, value] = counted.get(i);
+		assert(contained && value.val == i / 3);
+	}
+}
+
+// Hammer a few keys with every kind of update, none may get lost
+template<template<class> class Container, class V>
+void checkAtomicUpdates(const V &one, size_t (*count)(const V &)) {
+	const int THREADS = 20, KEYS = 10, ROUNDS = 200;
+	Hashmap<int, V, Container> counters(4);
+	vector<thread> jobs;
+	for (int t = 0; t < THREADS; t++) {
+		jobs.emplace_back([&] {
+			for (int i = 0; i < ROUNDS; i++) {
+				for (int key = 0; key < KEYS; key++) {
+					counters.fetchAdd(key, one);
+					counters.compute(key, [&](const V &current) { return current + one; });
+					counters.merge(key, one, [](const V &current, const V &delta) { return current + delta; });
+				}
+			}
+		});
+	}
+	for (thread &t : jobs)
+		t.join();
+	for (int key = 0; key < KEYS; key++) {
+		auto [contained, value] = counters.get(key);
+		assert(contained && count(value) == 3 * THREADS * ROUNDS);
+	}
+}
+
+// Threads race to claim keys and step their values, exactly one wins each
+template<template<class> class Container>
+void checkConditionalOps() {
+	const int THREADS = 20, KEYS = 100, STEPS = 50;
+	Hashmap<int, int, Container> owners(16);
+	std::atomic<int> claimed(0), exchanged(0);
+	vector<std::atomic<int>> advanced(KEYS);
+	vector<thread> jobs;
+	for (int t = 0; t < THREADS; t++) {
+		jobs.emplace_back([&, t] {
+			for (int key = 0; key < KEYS; key++) {
+				if (!owners.putIfAbsent(key, 0).first)
+					claimed++;
+				for (int step = 0; step < STEPS; step++)
+					if (owners.replace(key, step, step + 1).first)
+						advanced[key]++;
+				if (!owners.exchange(-1 - key, t).first)
+					exchanged++;
+			}
+		});
+	}
+	for (thread &t : jobs)
+		t.join();
+	assert(claimed == KEYS && exchanged == KEYS);
+	assert(owners.exactSize() == 2 * KEYS);
+	for (int key = 0; key < KEYS; key++)
+		assert(owners.get(key).second == advanced[key]);
+}
+
+// Iterate while writers churn other keys, keys that stay put are seen once each
+template<template<class> class Container, bool REMOVES = true>
+void checkIteration() {
+	const int STABLE = 1'000, CHURN = 1'000;
+	Hashmap<int, int, Container> iterated(64);
+	for (int key = 0; key < STABLE; key++)
+		iterated.put(key, -key);
+
+	std::atomic<bool> done(false);
+	vector<thread> writers;
+	for (int t = 0; t < 2; t++) {
+		writers.emplace_back([&, t] {
+			while (!done) {
+				for (int key = STABLE + t; key < STABLE + CHURN; key += 2)
+					iterated.put(key, key);
+				if constexpr (REMOVES)
+					for (int key = STABLE + t; key < STABLE + CHURN; key += 2)
+						iterated.remove(key);
+			}
+		});
+	}
+	for (int round = 0; round < 10; round++) {
+		vector<int> seen(STABLE);
+		for (const std::pair<int, int> &entry : iterated) {
+			assert(entry.first < STABLE + CHURN);
+			if (entry.first < STABLE) {
+				assert(entry.second == -entry.first);
+				seen[entry.first]++;
+			}
+		}
+		for (int count : seen)
+			assert(count == 1);
+
+		std::fill(seen.begin(), seen.end(), 0);
+		iterated.forEach([&](const int &key, const int &val) {
+			if (key < STABLE) {
+				assert(val == -key);
+				seen[key]++;
+			}
+		});
+		for (int count : seen)
+			assert(count == 1);
+	}
+	done = true;
+	for (thread &t : writers)
+		t.join();
+	if constexpr (REMOVES)
+		assert(iterated.exactSize() == STABLE);
+}
+
+size_t countLong(const long &val) { return val; }
+size_t countString(const string &val) { return val.size(); }
+
 int main() {
 	cout << "\n\nHASHMAP TESTING...\n\n";
 
@@ -63,6 +208,276 @@ int main() {
 		t.join();
 	threads.clear();
 
+	cout << "Testing batched get...\n";
+	vector<string> batch(rands.begin(), rands.begin() + 100);
+	for (int i = 0; i < 100; i++)
+		batch.push_back(rands[i] + "a");
+	auto results = hashmap.getMany(batch);
+	for (int i = 0; i < 200; i++)
+		assert(results[i].first == (i < 100) && (i >= 100 || results[i].second == i));
+
+	cout << "Testing batched put...\n";
+	Hashmap<int, int, ll::LockFreeLL> batched(100);
+	vector<int> keys(1'000), vals(1'000);
+	for (int i = 0; i < 1'000; i++) {
+		keys[i] = i * 7;
+		vals[i] = i;
+	}
+	batched.putMany(keys, vals);
+	for (int i = 0; i < 1'000; i++)
+		keys[i] = i;
+	vector<std::pair<bool, int>> out(1'000);
+	batched.getMany(keys.data(), 1'000, out.data());
+	for (int i = 0; i < 1'000; i++)
+		assert(out[i].first == (i % 7 == 0) && (!out[i].first || out[i].second == i / 7));
+
+	cout << "Testing sorted buckets...\n";
+	Hashmap<string, int, ll::SortedLockFreeLL> sorted(10);
+	for (int i = 0; i < 1'000; i++)
+		sorted.put(rands[i], i);
+	for (int i = 0; i < 1'000; i++) {
+		auto [contained, value] = sorted.get(rands[i]);
+		assert(contained && value == i);
+		assert(!sorted.get(rands[i] + "a").first);
+	}
+	for (int i = 0; i < 1'000; i += 2)
+		assert(sorted.remove(rands[i]));
+	for (int i = 0; i < 1'000; i++)
+		assert(sorted.get(rands[i]).first == (i & 1));
+
+	cout << "Testing hash entry points...\n";
+	std::hash<string> hasher;
+	Hashmap<string, int, ll::LockableLL> hashed(50);
+	for (int i = 0; i < 1'000; i++)
+		hashed.putWithHash(rands[i], i, hasher(rands[i]));
+	for (int i = 0; i < 1'000; i++) {
+		auto [contained, value] = hashed.get(rands[i]);
+		assert(contained && value == i);
+		assert(hashed.getWithHash(rands[i], hasher(rands[i])).second == i);
+		assert(!hashed.getWithHash(rands[i] + "a", hasher(rands[i] + "a")).first);
+	}
+
+	cout << "Testing transparent lookup...\n";
+	Hashmap<string, int, ll::SortedLockFreeLL, tshm::StringHash> transparent(50);
+	for (int i = 0; i < 1'000; i++)
+		transparent.put(rands[i], i);
+	char buffer[16];
+	for (int i = 0; i < 1'000; i++) {
+		rands[i].copy(buffer, rands[i].size());
+		std::string_view view(buffer, rands[i].size());
+		auto [contained, value] = transparent.get(view);
+		assert(contained && value == i);
+		assert(!transparent.get(view.substr(1)).first);
+	}
+	assert(transparent.get(rands[0].c_str()).second == 0);
+	for (int i = 0; i < 1'000; i += 2)
+		assert(transparent.remove(std::string_view(rands[i])));
+	for (int i = 0; i < 1'000; i++)
+		assert(transparent.get(std::string_view(rands[i])).first == (i & 1));
+
+	cout << "Testing move and emplace...\n";
+	checkNoCopies<ll::AddOnlyLockFreeLL>();
+	checkNoCopies<ll::LockFreeLL>();
+	checkNoCopies<ll::SortedLockFreeLL>();
+	checkNoCopies<ll::LockableLL>();
+	checkNoCopies<ll::SeqLockLL>();
+
+	cout << "Testing visit...\n";
+	{
+		Hashmap<int, Counted, ll::LockFreeLL> visited(100);
+		for (int i = 0; i < 1'000; i++)
+			visited.put(i, Counted(i));
+		Counted::copies = 0;
+		long long sum = 0;
+		for (int i = 0; i < 1'000; i++)
+			assert(visited.visit(i, [&](const Counted &value) { sum += value.val; }));
+		assert(!visited.visit(-1, [&](const Counted &) { assert(false); }));
+		assert(sum == 999 * 1'000 / 2 && Counted::copies == 0);
+
+		// Visitors racing removes only ever see whole values
+		vector<thread> racers;
+		for (int t = 0; t < 4; t++) {
+			racers.emplace_back([&, t] {
+				for (int i = t; i < 1'000; i += 4) {
+					if (t & 1)
+						visited.remove(i - 1);
+					visited.visit(i, [&](const Counted &value) { assert(value.val == i); });
+				}
+			});
+		}
+		for (thread &t : racers)
+			t.join();
+	}
+
+	cout << "Testing transparent visit...\n";
+	int visitedValue = -1;
+	assert(transparent.visit(std::string_view(rands[1]), [&](const int &value) { visitedValue = value; }));
+	assert(visitedValue == 1);
+
+	cout << "Testing compute, merge and fetchAdd...\n";
+	Hashmap<string, int> counting(10);
+	assert(counting.fetchAdd("a", 5) == 0);
+	assert(counting.fetchAdd("a", 2) == 5);
+	assert(counting.compute("a", [](const int &current) { return current * 2; }) == 14);
+	assert(counting.compute("b", [](const int &current) { return current + 3; }) == 3);
+	assert(counting.merge("b", 4, [](const int &current, const int &delta) { return current * delta; }) == 12);
+	assert(counting.merge("c", 4, [](const int &, const int &) { return -1; }) == 4);
+	assert(counting.get("a").second == 14 && counting.get("b").second == 12 && counting.get("c").second == 4);
+	checkAtomicUpdates<ll::AddOnlyLockFreeLL, long>(1, countLong);
+	checkAtomicUpdates<ll::LockFreeLL, long>(1, countLong);
+	checkAtomicUpdates<ll::SortedLockFreeLL, long>(1, countLong);
+	checkAtomicUpdates<ll::LockableLL, long>(1, countLong);
+	checkAtomicUpdates<ll::SeqLockLL, long>(1, countLong);
+	checkAtomicUpdates<ll::AddOnlyLockFreeLL, string>("x", countString);
+	checkAtomicUpdates<ll::LockFreeLL, string>("x", countString);
+	checkAtomicUpdates<ll::LockableLL, string>("x", countString);
+	checkAtomicUpdates<ll::SeqLockLL, string>("x", countString);
+
+	cout << "Testing conditional ops...\n";
+	Hashmap<string, string, ll::LockFreeLL> leases(10);
+	assert(leases.putIfAbsent("lease", "a") == std::make_pair(false, string()));
+	assert(leases.putIfAbsent("lease", "b") == std::make_pair(true, string("a")));
+	assert(leases.replace("lease", "b", "c") == std::make_pair(false, string("a")));
+	assert(leases.replace("lease", "a", "c") == std::make_pair(true, string("a")));
+	assert(leases.replace("missing", "", "c") == std::make_pair(false, string()));
+	assert(!leases.get("missing").first);
+	assert(leases.exchange("lease", "d") == std::make_pair(true, string("c")));
+	assert(leases.exchange("other", "e") == std::make_pair(false, string()));
+	assert(leases.get("lease").second == "d" && leases.get("other").second == "e");
+	checkConditionalOps<ll::AddOnlyLockFreeLL>();
+	checkConditionalOps<ll::LockFreeLL>();
+	checkConditionalOps<ll::LockableLL>();
+	checkConditionalOps<ll::SeqLockLL>();
+
+	cout << "Testing put overwrites...\n";
+	Hashmap<int, string, ll::LockFreeLL> overwritten(10);
+	overwritten.put(1, "old");
+	overwritten.put(1, "new");
+	assert(overwritten.get(1).second == "new");
+
+	cout << "Testing iteration...\n";
+	{
+		Hashmap<string, int> empty(10), single(10);
+		assert(empty.begin() == empty.end());
+		single.put("a", 1);
+		auto it = single.begin();
+		assert(it->first == "a" && it->second == 1 && ++it == single.end());
+		assert(std::distance(overwritten.begin(), overwritten.end()) == 1);
+	}
+	checkIteration<ll::AddOnlyLockFreeLL, false>();
+	checkIteration<ll::LockFreeLL>();
+	checkIteration<ll::SortedLockFreeLL>();
+	checkIteration<ll::LockableLL>();
+	checkIteration<ll::SeqLockLL>();
+
+	cout << "Testing parallel forEach and reduce...\n";
+	{
+		// Few buckets for many keys, so chains are long and uneven
+		Hashmap<int, long, ll::LockFreeLL> scanned(97);
+		for (int key = 0; key < 20'000; key++)
+			scanned.put(key, key % 7 == 0 ? 1'000 : 1);
+		long expected = 0;
+		scanned.forEach([&](const int &, const long &val) { expected += val; });
+
+		for (uint threads : {1u, 4u, 16u}) {
+			std::atomic<long> sum(0);
+			std::atomic<int> entries(0);
+			scanned.parallelForEach([&](const int &, const long &val) { sum += val; entries++; }, threads);
+			assert(sum == expected && entries == 20'000);
+
+			long reduced = scanned.parallelReduce(5L,
+				[](const int &, const long &val) { return val; },
+				[](long a, long b) { return a + b; }, threads);
+			assert(reduced == expected + 5);
+			int maxKey = scanned.parallelReduce(-1,
+				[](const int &key, const long &) { return key; },
+				[](int a, int b) { return std::max(a, b); }, threads);
+			assert(maxKey == 19'999);
+		}
+
+		Hashmap<int, long> nothing(10);
+		assert(nothing.parallelReduce(3L, [](const int &, const long &) { return 1L; }, std::plus<long>()) == 3);
+	}
+
+	cout << "Testing size...\n";
+	{
+		Hashmap<int, int, ll::LockFreeLL> sized(64);
+		assert(sized.size() == 0 && sized.exactSize() == 0);
+		vector<thread> jobs;
+		for (int t = 0; t < 8; t++) {
+			jobs.emplace_back([&sized, t] {
+				for (int key = 0; key < 5'000; key++) {
+					sized.put(key, t);
+					sized.try_emplace(key + 5'000, t);
+					sized.fetchAdd(key + 10'000, 1);
+				}
+			});
+		}
+		for (thread &t : jobs)
+			t.join();
+		jobs.clear();
+		assert(sized.exactSize() == 15'000);
+		for (int t = 0; t < 8; t++) {
+			jobs.emplace_back([&sized, t] {
+				for (int key = t; key < 5'000; key += 8)
+					assert(sized.remove(key));
+			});
+		}
+		for (thread &t : jobs)
+			t.join();
+
+		// Off by less than 32 per shard, and exact below 512 per shard
+		long shards = counter::ShardedCounter().shardCount();
+		long drift = (long)sized.size() - 10'000;
+		assert(sized.exactSize() == 10'000 && drift < 32 * shards && -drift < 32 * shards);
+		assert(10'000 >= 512 * shards || drift == 0);
+
+		// Fewer than the threshold, nothing ever gets published
+		Hashmap<int, int, ll::LockFreeLL> small(64);
+		for (int key = 0; key < 20; key++)
+			small.put(key, key);
+		assert(small.size() == 20 && small.exactSize() == 20);
+		for (int key = 0; key < 5; key++)
+			small.remove(key);
+		assert(small.size() == 15);
+	}
+
+	cout << "Testing stats...\n";
+	{
+		// std::hash<int> is the identity, so we know where every key lands
+		Hashmap<int, int, ll::LockableLL> even(10), skewed(100, 10);
+		for (int key = 0; key < 100; key++)
+			even.put(key, key);
+		for (int key = 0; key < 20; key++)
+			skewed.put(key % 4 == 0 ? key * 100 : key, key);
+
+		ll::BucketStats stats = even.stats(4);
+		assert(stats.buckets == 10 && stats.usedBuckets == 10 && stats.items == 100);
+		assert(stats.maxChain == 10 && stats.chainHistogram.size() == 11 && stats.chainHistogram[10] == 10);
+		assert(stats.p50Chain == 10 && stats.p99Chain == 10 && stats.loadFactor == 10);
+		assert(stats.nodeBytes >= 100 * sizeof(tshm::Entry<int, int>) && stats.filterBytes == 0);
+		assert(stats.bucketBytes > 0 && stats.bytesPerItem() * 100 > stats.totalBytes() - 1);
+
+		// Five keys share bucket 0, the other fifteen have one each
+		stats = skewed.stats(3);
+		assert(stats.usedBuckets == 16 && stats.items == 20 && stats.maxChain == 5);
+		assert(stats.chainHistogram[0] == 84 && stats.chainHistogram[1] == 15 && stats.chainHistogram[5] == 1);
+		assert(stats.p50Chain == 1 && stats.p90Chain == 1 && stats.p99Chain == 5);
+		assert(stats.loadFactor == 0.2 && stats.filterBytes > 0);
+
+		Hashmap<int, int> unused(1'000);
+		stats = unused.stats();
+		assert(stats.usedBuckets == 0 && stats.maxChain == 0 && stats.p99Chain == 0 && stats.nodeBytes == 0);
+	}
+
+	cout << "Testing large empty map...\n";
+	{
+		Hashmap<int, int, ll::LockFreeLL> large(2'500'000);
+		assert(!large.get(7).first && !large.remove(7));
+		large.put(7, 8);
+		assert(large.get(7).second == 8);
+	}
+
 	cout << "\nSuccess :D\n";
 
 	return 0;
@@ -5,6 +5,8 @@
 #include <set>
 #include <vector>
 #include <thread>
+#include <string_view>
+#include <atomic>
 #include "../src/Hashset.h"
 
 using std::cout;
@@ -63,6 +65,126 @@ int main() {
 		t.join();
 	threads.clear();
 
+	cout << "Testing batched contains...\n";
+	vector<string> batch(rands.begin(), rands.begin() + 100);
+	for (int i = 0; i < 100; i++)
+		batch.push_back(rands[i] + "a");
+	vector<bool> found = hashset.containsMany(batch);
+	for (int i = 0; i < 200; i++)
+		assert(found[i] == (i < 100));
+
+	cout << "Testing batched insert...\n";
+	Hashset<int, ll::LockableLL> batched(100);
+	vector<int> items(1'000);
+	for (int i = 0; i < 1'000; i++)
+		items[i] = i * 3;
+	batched.insertMany(items);
+	for (int i = 0; i < 1'000; i++)
+		items[i] = i;
+	found = batched.containsMany(items);
+	for (int i = 0; i < 1'000; i++)
+		assert(found[i] == (i % 3 == 0));
+
+	cout << "Testing hash entry points...\n";
+	std::hash<string> hasher;
+	for (int i = 0; i < 100; i++) {
+		assert(hashset.containsWithHash(rands[i], hasher(rands[i])));
+		hashset.insertWithHash(rands[i] + "b", hasher(rands[i] + "b"));
+		assert(hashset.contains(rands[i] + "b"));
+	}
+
+	cout << "Testing transparent lookup...\n";
+	Hashset<string, ll::LockableLL, tshm::StringHash> transparent(50);
+	for (int i = 0; i < 100; i++)
+		transparent.insert(rands[i]);
+	for (int i = 0; i < 200; i++) {
+		std::string_view view(rands[i]);
+		assert(transparent.contains(view) == (i < 100));
+		assert(!transparent.contains(view.substr(0, 4)));
+	}
+
+	cout << "Testing move and emplace...\n";
+	Hashset<string, ll::LockFreeLL> moved(50);
+	for (int i = 0; i < 100; i++) {
+		string item = rands[i];
+		moved.insert(std::move(item));
+		assert(moved.emplace(rands[i] + "c"));
+		assert(!moved.emplace(rands[i]));
+	}
+	for (int i = 0; i < 100; i++)
+		assert(moved.contains(rands[i]) && moved.contains(rands[i] + "c"));
+
+	cout << "Testing insert results and erase...\n";
+	Hashset<int, ll::LockFreeLL> erasable(64);
+	std::atomic<int> added(0), erased(0);
+	for (int t = 0; t < 8; t++) {
+		threads.emplace_back([&] {
+			for (int i = 0; i < 1'000; i++)
+				added += erasable.insert(i);
+		});
+	}
+	for (thread &t : threads)
+		t.join();
+	threads.clear();
+	for (int t = 0; t < 8; t++) {
+		threads.emplace_back([&] {
+			for (int i = 0; i < 1'000; i += 2)
+				erased += erasable.erase(i);
+		});
+	}
+	for (thread &t : threads)
+		t.join();
+	threads.clear();
+	assert(added == 1'000 && erased == 500);
+	long drift = (long)erasable.size() - 500, slack = 32 * counter::ShardedCounter().shardCount();
+	assert(erasable.exactSize() == 500 && drift < slack && -drift < slack);
+	for (int i = 0; i < 1'000; i++)
+		assert(erasable.contains(i) == (i % 2 == 1));
+	assert(!erasable.erase(0));
+	int visited = 0;
+	erasable.forEach([&](const int &item) { assert(item % 2 == 1); visited++; });
+	assert(visited == 500);
+	set<int> iterated(erasable.begin(), erasable.end());
+	assert(iterated.size() == 500 && *iterated.begin() == 1 && *iterated.rbegin() == 999);
+
+	cout << "Testing parallel forEach and reduce...\n";
+	std::atomic<long> oddSum(0);
+	erasable.parallelForEach([&](const int &item) { oddSum += item; }, 4);
+	assert(oddSum == 500L * 500);
+	assert(erasable.parallelReduce(0L, [](const int &item) { return (long)item; }, std::plus<long>(), 4) == 500L * 500);
+	assert(erasable.parallelReduce(string(), [](const int &) { return string("x"); }, std::plus<string>(), 3).size() == 500);
+
+	cout << "Testing stats...\n";
+	ll::BucketStats stats = erasable.stats(2);
+	assert(stats.buckets == 64 && stats.items == 500 && stats.usedBuckets <= 64);
+	assert(stats.maxChain >= stats.p99Chain && stats.p99Chain >= stats.p50Chain && stats.p50Chain > 0);
+	assert(stats.nodeBytes >= 500 * sizeof(int));
+
+	cout << "Testing set algebra...\n";
+	Hashset<int, ll::LockFreeLL> left(64), right(100), empty(10);
+	for (int i = 0; i < 3'000; i++) {
+		if (i % 2 == 0)
+			left.insert(i);
+		if (i % 3 == 0)
+			right.insert(i);
+	}
+	Hashset<int, ll::LockFreeLL> both(64), onlyLeft(64), either(64);
+	for (Hashset<int, ll::LockFreeLL> *result : {&both, &onlyLeft, &either})
+		result->unionWith(left, 4);
+	both.intersect(right, 4);
+	onlyLeft.difference(right, 4);
+	either.unionWith(right, 4);
+	for (int i = 0; i < 3'000; i++) {
+		assert(both.contains(i) == (i % 6 == 0));
+		assert(onlyLeft.contains(i) == (i % 2 == 0 && i % 3 != 0));
+		assert(either.contains(i) == (i % 2 == 0 || i % 3 == 0));
+	}
+	either.intersect(either);
+	assert(either.contains(0) && either.contains(3));
+	either.difference(either);
+	either.unionWith(empty);
+	either.forEach([](const int &) { assert(false); });
+
 	cout << "\nSuccess :D\n";
 
 	return 0;
@@ -0,0 +1,150 @@
+#include <iostream>
+#include <assert.h>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include "../src/Instrumentation.h"
+#include "../src/LinkedList.h"
+#include "../src/Semaphore.h"
+
+using std::cout;
+using std::vector;
+using std::thread;
+using std::string;
+
+using instrument::Counters;
+
+template<class T>
+using CountedLockFreeLL = ll::LockFreeLL<T, reclaim::EpochBased, alloc::HeapAllocator, false, Counters>;
+template<class T>
+using CountedAddOnlyLL = ll::AddOnlyLockFreeLL<T, alloc::HeapAllocator, false, Counters>;
+template<class T>
+using CountedLockableLL = ll::LockableLL<T, alloc::HeapAllocator, Counters>;
+
+// Race threads over one list, every op must still land
+template<class List, bool REMOVES = true>
+void hammer(List &list) {
+	const int THREADS = 8, LIM = 2'000;
+	vector<thread> jobs;
+	for (int t = 0; t < THREADS; t++) {
+		jobs.emplace_back([&list, t] {
+			for (int x = t; x < LIM; x += THREADS)
+				list.add(x);
+			if constexpr (REMOVES)
+				for (int x = t; x < LIM; x += 2 * THREADS)
+					assert(list.remove(x));
+		});
+	}
+	for (thread &t : jobs)
+		t.join();
+	assert(list.size() == (REMOVES ? LIM / 2 : LIM));
+}
+
+int main() {
+	cout << "\n\nINSTRUMENTATION TESTING...\n\n";
+
+	cout << "Testing disabled is free...\n";
+	static_assert(!instrument::Disabled::enabled && Counters::enabled);
+	static_assert(sizeof(MarkableReference<int>) == sizeof(uintptr_t));
+	static_assert(sizeof(ll::LockFreeLL<int>) == sizeof(CountedLockFreeLL<int>));
+
+	cout << "Testing per thread counts...\n";
+	Counters::reset();
+	thread first([] { Counters::count(instrument::LL_FIND_RETRY, 3); });
+	first.join();
+	thread second([] {
+		Counters::count(instrument::LL_FIND_RETRY);
+		Counters::count(instrument::LOCK_WAITS, 5);
+	});
+	second.join();
+	Counters::Totals totals = Counters::totals();
+	assert(totals[instrument::LL_FIND_RETRY] == 4 && totals[instrument::LOCK_WAITS] == 5);
+	assert(totals[instrument::LL_ADD_CAS_FAILURE] == 0);
+	int withRetries = 0;
+	for (const Counters::Totals &thread : Counters::perThread())
+		withRetries += thread[instrument::LL_FIND_RETRY] > 0;
+	assert(withRetries == 2);
+
+	cout << "Testing dump...\n";
+	string path = "/tmp/tshm_instrumentation.csv";
+	assert(Counters::dumpCsv(path));
+	std::ifstream dump(path);
+	string line;
+	std::getline(dump, line);
+	assert(line == "thread,event,count");
+	int rows = 0;
+	long lockWaits = 0;
+	while (std::getline(dump, line)) {
+		rows++;
+		if (line.find(",lock_waits,") != string::npos)
+			lockWaits += std::stol(line.substr(line.rfind(',') + 1));
+	}
+	assert(rows == (int)Counters::perThread().size() * instrument::EVENT_COUNT && lockWaits == 5);
+	assert(!Counters::dumpCsv("/nonexistent/dir/file.csv"));
+
+	cout << "Testing lists under contention...\n";
+	Counters::reset();
+	CountedLockFreeLL<int> lockFree;
+	CountedAddOnlyLL<int> addOnly;
+	CountedLockableLL<int> lockable;
+	hammer(lockFree);
+	hammer<CountedAddOnlyLL<int>, false>(addOnly);
+	hammer(lockable);
+	totals = Counters::totals();
+	cout << "Lost CAS races and retries: " <<
+		totals[instrument::LL_ADD_CAS_FAILURE] << " add, " <<
+		totals[instrument::LL_REMOVE_CAS_FAILURE] << " remove, " <<
+		totals[instrument::LL_FIND_RETRY] << " find, " <<
+		totals[instrument::ADD_ONLY_CAS_FAILURE] << " add only\n";
+	cout << "Lock waits: " << totals[instrument::LOCK_WAITS] << "\n";
+	assert((totals[instrument::LOCK_WAITS] == 0) == (totals[instrument::LOCK_WAIT_NANOS] == 0));
+
+	cout << "Testing exchangeRef...\n";
+	Counters::reset();
+	int targets[2];
+	MarkableReference<int, Counters> ref(&targets[0], true);
+	assert(ref.exchangeRef(&targets[1]) == &targets[0] && ref.getRef() == &targets[1] && ref.getMark());
+	assert(Counters::totals()[instrument::EXCHANGE_REF_CAS_FAILURE] == 0);
+
+	cout << "Testing lock waits...\n";
+	// A slow forEach holds the head's lock, so an add behind it has to wait
+	Counters::reset();
+	CountedLockableLL<int> slow;
+	slow.add(1);
+	std::atomic<bool> holding(false);
+	thread walker([&] {
+		slow.forEach([&](const int &) {
+			holding = true;
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		});
+	});
+	while (!holding)
+		std::this_thread::yield();
+	slow.add(2);
+	walker.join();
+	totals = Counters::totals();
+	assert(totals[instrument::LOCK_WAITS] >= 1 && totals[instrument::LOCK_WAIT_NANOS] >= 10'000'000);
+
+	cout << "Testing semaphore waits...\n";
+	Counters::reset();
+	semaphore::BasicCountingSemaphore<Counters> sem(1);
+	sem.acquire();
+	assert(Counters::totals()[instrument::SEMAPHORE_WAITS] == 0);
+	thread releaser([&sem] {
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		sem.release();
+	});
+	sem.acquire();
+	releaser.join();
+	totals = Counters::totals();
+	assert(totals[instrument::SEMAPHORE_WAITS] == 1 && totals[instrument::SEMAPHORE_WAIT_NANOS] >= 10'000'000);
+	semaphore::CountingSemaphore plain(1);
+	plain.acquire();
+	plain.release();
+
+	cout << "\nSuccess :D\n";
+	return 0;
+}
@@ -8,6 +8,7 @@
 using std::vector; using std::thread;
 using std::cout;
 using ll::LockFreeLL;
+using ll::SortedLockFreeLL;
 
 int main() {
 	cout << "\n\nTESTING LOCK FREE LINKED LIST...\n\n";
@@ -19,6 +20,9 @@ int main() {
 	cout << "Testing sequential add...\n";
 	LockFreeLL<int> sequentialList;
 	assert(sequentialList.size() == 0);
+	int missing = 0;
+	assert(!sequentialList.find(missing) && !sequentialList.remove(0));
+	assert(sequentialList.NOT_THREAD_SAFE_getHead() == nullptr);
 	for (int x = 0; x < 10; x++)
 		sequentialList.add(x);
 	assert(sequentialList.size() == 10);
@@ -87,7 +91,6 @@ int main() {
 	auto curr = threadedList.NOT_THREAD_SAFE_getHead();
 	int found = 0;
 	while (curr != nullptr) {
-		assert(curr->watchers == 0);
 		found++;
 		curr = curr->next.getRef();
 	}
@@ -114,6 +117,89 @@ int main() {
 		t.join();
 	jobs.clear();
 
+	/*
+	 * SORTED TESTING
+	 */
+	cout << "\nBEGINNING SORTED CHECKS\n";
+	cout << "-----------------------\n";
+	cout << "Testing sorted add and misses...\n";
+	SortedLockFreeLL<int> sortedList;
+	for (int thread = 0; thread < THREADS; thread++)
+		jobs.emplace_back([&sortedList](int start) {
+			for (int x = start; x < LIM; x += THREADS)
+				sortedList.add(x * 3);
+		}, thread);
+	for (thread &t : jobs)
+		t.join();
+	jobs.clear();
+	assert(sortedList.size() == LIM);
+	for (int x = 0; x < 3 * LIM; x++) {
+		int search = x;
+		bool found = sortedList.find(search);
+		assert(found == (x % 3 == 0));
+	}
+
+	cout << "Checking hash order...\n";
+	auto sortedCurr = sortedList.NOT_THREAD_SAFE_getHead()->next.getRef();
+	size_t lastHash = 0;
+	while (!sortedCurr->isCap) {
+		assert(sortedCurr->hash >= lastHash);
+		lastHash = sortedCurr->hash;
+		sortedCurr = sortedCurr->next.getRef();
+	}
+
+	cout << "Testing sorted remove...\n";
+	for (int x = 0; x < LIM; x += 2)
+		assert(sortedList.remove(x * 3));
+	assert(!sortedList.remove(1));
+	for (int x = 0; x < LIM; x++) {
+		int search = x * 3;
+		assert(sortedList.find(search) == (x & 1));
+	}
+
+	cout << "Testing forEach during removal...\n";
+	LockFreeLL<int, reclaim::HazardPointers> walkedList;
+	for (int x = 0; x < 2'000; x++)
+		walkedList.add(x);
+	thread remover([&walkedList] {
+		for (int x = 0; x < 2'000; x += 2)
+			walkedList.remove(x);
+	});
+	for (int pass = 0; pass < 20; pass++) {
+		std::set<int> walked;
+		walkedList.forEach([&walked](const int &x) { assert(walked.insert(x).second); });
+		for (int x = 1; x < 2'000; x += 2)
+			assert(walked.count(x));
+	}
+	remover.join();
+	int walkedCount = 0;
+	walkedList.forEach([&walkedCount](const int &x) { assert(x & 1); walkedCount++; });
+	assert(walkedCount == 1'000);
+
+	cout << "Testing sorted forEach during removal, with shared hashes...\n";
+	auto walkWhileRemoving = [](auto &list) {
+		for (int x = 0; x < 2'000; x++)
+			list.add(x, x / 4);
+		thread remover([&list] {
+			for (int x = 0; x < 2'000; x += 2)
+				list.remove(x, x / 4);
+		});
+		for (int pass = 0; pass < 20; pass++) {
+			std::set<int> walked;
+			list.forEach([&walked](const int &x) { assert(walked.insert(x).second); });
+			for (int x = 1; x < 2'000; x += 2)
+				assert(walked.count(x));
+		}
+		remover.join();
+		int count = 0;
+		list.forEach([&count](const int &x) { assert(x & 1); count++; });
+		assert(count == 1'000);
+	};
+	LockFreeLL<int, reclaim::HazardPointers, alloc::HeapAllocator, true> sortedWalked;
+	walkWhileRemoving(sortedWalked);
+	SortedLockFreeLL<int> epochWalked;
+	walkWhileRemoving(epochWalked);
+
 	cout << "\nSuccess :D\n";
 	return 0;
 }
@@ -21,6 +21,9 @@ int main() {
 	cout << "Testing sequential add...\n";
 	LockableLL<int> sequentialList;
 	assert(sequentialList.size() == 0);
+	int missing = 0;
+	assert(!sequentialList.find(missing) && !sequentialList.remove(0));
+	assert(sequentialList.NOT_THREAD_SAFE_getHead() == nullptr);
 	for (int x = 0; x < 10; x++)
 		sequentialList.add(x);
 	assert(sequentialList.size() == 10);
@@ -2,10 +2,18 @@
 #include <string>
 #include <assert.h>
 #include <functional>
+#include <future>
+#include <vector>
+#include <thread>
+#include <atomic>
 #include "../src/Hashmap.h"
 
 using std::cout;
 using std::string;
+using std::vector;
+using std::thread;
+using std::future;
+using std::atomic;
 
 using tshm::ManagedHashmap;
 
@@ -42,6 +50,72 @@ int main() {
 		assert(contained && value == 2*i);
 	}
 
+	cout << "Testing many queued puts...\n";
+	{
+		ManagedHashmap<int, int> many(1'000, 4, 64);
+		for (int i = 0; i < 50'000; i++)
+			many.put(i, i + 1);
+		for (int i = 0; i < 50'000; i += 7) {
+			auto [contained, value] = many.get(i);
+			assert(contained && value == i + 1);
+		}
+		assert(!many.get(50'000).first);
+	}
+
+	cout << "Testing async gets...\n";
+	{
+		ManagedHashmap<int, int> async(1'000, 4, 256);
+		vector<future<std::pair<bool, int>>> results;
+		for (int i = 0; i < 10'000; i++) {
+			async.put(i, i * 3);
+			results.push_back(async.getAsync(i));
+		}
+		for (int i = 0; i < 10'000; i++) {
+			auto [contained, value] = results[i].get();
+			assert(contained && value == i * 3);
+		}
+		assert(!async.getAsync(-1).get().first);
+
+		cout << "Testing async get callbacks...\n";
+		atomic<int> served(0), found(0);
+		for (int i = 0; i < 20'000; i++) {
+			async.getAsync(i, [&, i](bool contained, const int &value) {
+				if (contained && value == i * 3)
+					found++;
+				served++;
+			});
+		}
+		async.put(-1, 0);
+		assert(async.get(-1).first);
+		assert(served == 20'000 && found == 10'000);
+	}
+
+	cout << "Testing async gets from many threads...\n";
+	{
+		ManagedHashmap<int, int> shared(1'000, 4, 128);
+		vector<thread> jobs;
+		for (int t = 0; t < 4; t++) {
+			jobs.emplace_back([&, t] {
+				for (int i = t; i < 20'000; i += 4) {
+					shared.put(i, i + 7);
+					if (i % 16 < 4) {
+						auto [contained, value] = shared.getAsync(i).get();
+						assert(contained && value == i + 7);
+					}
+				}
+			});
+		}
+		for (thread &t : jobs)
+			t.join();
+	}
+
+	cout << "Testing destruct with queued puts...\n";
+	{
+		ManagedHashmap<int, int> dropped(1'000, 2);
+		for (int i = 0; i < 10'000; i++)
+			dropped.put(i, i);
+	}
+
 	cout << "\nSuccess :D\n";
 
 	return 0;
@@ -0,0 +1,127 @@
+#include <assert.h>
+#include <vector>
+#include <thread>
+#include <set>
+#include <string>
+#include <iostream>
+#include "../src/Hashmap.h"
+
+using std::vector;
+using std::thread;
+using std::set;
+using std::string;
+using std::cout;
+
+using alloc::PooledAllocator;
+using tshm::Hashmap;
+
+// Small node, shares a size class with the list nodes
+struct Small {
+	long a, b;
+	Small(long a = 0, long b = 0) : a(a), b(b) {}
+};
+
+// Bigger than every size class
+struct Huge {
+	char bytes[4'096];
+};
+
+// Fill a list, check it, then drain it
+template<class List, bool Removable>
+void churnList() {
+	List list;
+	for (int x = 0; x < 1'000; x++)
+		list.add(x);
+	for (int x = 0; x < 1'000; x++) {
+		int search = x;
+		assert(list.find(search) && search == x);
+	}
+	if constexpr (Removable) {
+		for (int x = 0; x < 1'000; x++)
+			assert(list.remove(x));
+		assert(list.size() == 0);
+	}
+}
+
+int main() {
+	cout << "\n\nNODE POOL TESTING...\n\n";
+
+	cout << "Testing recycling...\n";
+	Small *first = PooledAllocator::create<Small>(1, 2);
+	assert(first->a == 1 && first->b == 2);
+	PooledAllocator::destroy(first);
+	Small *second = PooledAllocator::create<Small>();
+	assert(second == first);
+	PooledAllocator::destroy(second);
+
+	cout << "Testing footprint...\n";
+	auto before = PooledAllocator::footprint();
+	assert(before.reservedBytes >= PooledAllocator::SLAB_BYTES);
+	vector<Small *> nodes;
+	for (int x = 0; x < 10'000; x++)
+		nodes.push_back(PooledAllocator::create<Small>(x, x));
+	set<Small *> unique(nodes.begin(), nodes.end());
+	assert(unique.size() == nodes.size());
+	auto during = PooledAllocator::footprint();
+	assert(during.reservedBytes > before.reservedBytes);
+	assert(during.outstandingBytes >= 10'000 * sizeof(Small));
+	for (Small *node : nodes)
+		PooledAllocator::destroy(node);
+	auto after = PooledAllocator::footprint();
+	assert(after.reservedBytes == during.reservedBytes);
+	assert(after.outstandingBytes < during.outstandingBytes);
+
+	cout << "Testing oversized nodes...\n";
+	Huge *huge = PooledAllocator::create<Huge>();
+	huge->bytes[4'095] = 'x';
+	PooledAllocator::destroy(huge);
+	assert(PooledAllocator::footprint().reservedBytes == after.reservedBytes);
+
+	cout << "Testing cross thread frees...\n";
+	vector<Small *> handoff(10'000);
+	thread producer([&] {
+		for (int x = 0; x < 10'000; x++)
+			handoff[x] = PooledAllocator::create<Small>(x, -x);
+	});
+	producer.join();
+	vector<thread> jobs;
+	for (int t = 0; t < 4; t++) {
+		jobs.emplace_back([&, t] {
+			for (int x = t; x < 10'000; x += 4) {
+				assert(handoff[x]->a == x && handoff[x]->b == -x);
+				PooledAllocator::destroy(handoff[x]);
+			}
+		});
+	}
+	for (thread &t : jobs)
+		t.join();
+	jobs.clear();
+
+	cout << "Testing pooled containers...\n";
+	churnList<ll::LockFreeLL<int, reclaim::EpochBased, PooledAllocator>, true>();
+	churnList<ll::LockableLL<int, PooledAllocator>, true>();
+	churnList<ll::AddOnlyLockFreeLL<int, PooledAllocator>, false>();
+
+	cout << "Testing pooled hashmap...\n";
+	Hashmap<string, int, ll::LockFreeLL, std::hash<string>, PooledAllocator> hashmap(100);
+	for (int t = 0; t < 4; t++) {
+		jobs.emplace_back([&, t] {
+			for (int x = t; x < 2'000; x += 4)
+				hashmap.put(std::to_string(x), x);
+			for (int x = t; x < 2'000; x += 4) {
+				auto [contained, value] = hashmap.get(std::to_string(x));
+				assert(contained && value == x);
+			}
+			for (int x = t; x < 2'000; x += 8)
+				assert(hashmap.remove(std::to_string(x)));
+		});
+	}
+	for (thread &t : jobs)
+		t.join();
+	jobs.clear();
+	for (int x = 0; x < 2'000; x++)
+		assert(hashmap.get(std::to_string(x)).first == (x % 8 >= 4));
+
+	cout << "\nSuccess :D\n";
+	return 0;
+}
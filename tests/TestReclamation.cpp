@@ -0,0 +1,165 @@
+#include <assert.h>
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <iostream>
+#include "../src/LinkedList.h"
+
+using std::vector;
+using std::thread;
+using std::cout;
+using std::atomic;
+
+using ll::LockFreeLL;
+
+// Count frees going through the reclaimer
+atomic<int> freed(0);
+void countingDeleter(void *ptr) {
+	delete static_cast<int *>(ptr);
+	freed++;
+}
+
+atomic<bool> pinnedFreed(false);
+void pinnedDeleter(void *ptr) {
+	delete static_cast<int *>(ptr);
+	pinnedFreed = true;
+}
+
+// Run the same checks against any policy
+template<class Reclaimer>
+void testPolicy() {
+	const int BATCH = 1'000;
+
+	cout << "Testing unprotected nodes get freed...\n";
+	freed = 0;
+	for (int x = 0; x < BATCH; x++)
+		Reclaimer::retire(new int(x), countingDeleter);
+	// Epochs need a couple of scans to catch up
+	for (int x = 0; x < BATCH; x++)
+		Reclaimer::retire(new int(x), countingDeleter);
+	assert(freed >= BATCH);
+
+	cout << "Testing guarded nodes are kept...\n";
+	int *pinned = new int(-1);
+	atomic<bool> guarding(false), retired(false);
+	thread reader([&] {
+		typename Reclaimer::Guard guard;
+		guard.protect(0, pinned);
+		guarding = true;
+		while (!retired);
+		// Still readable while we hold the guard
+		assert(*pinned == -1);
+	});
+	while (!guarding);
+
+	pinnedFreed = false;
+	Reclaimer::retire(pinned, pinnedDeleter);
+	for (int x = 0; x < 2 * BATCH; x++)
+		Reclaimer::retire(new int(x), countingDeleter);
+	assert(!pinnedFreed);
+	retired = true;
+	reader.join();
+
+	cout << "Testing nodes are freed once the guard closes...\n";
+	for (int x = 0; x < 2 * BATCH; x++)
+		Reclaimer::retire(new int(x), countingDeleter);
+	assert(pinnedFreed);
+
+	cout << "Testing nested guards keep the outer one's nodes...\n";
+	pinned = new int(-2);
+	int *other = new int(-3);
+	guarding = false, retired = false;
+	thread nester([&] {
+		typename Reclaimer::Guard outer;
+		outer.protect(0, pinned);
+		{
+			typename Reclaimer::Guard inner;
+			inner.protect(0, other);
+		}
+		guarding = true;
+		while (!retired);
+		assert(*pinned == -2);
+	});
+	while (!guarding);
+
+	pinnedFreed = false;
+	Reclaimer::retire(pinned, pinnedDeleter);
+	Reclaimer::retire(other, countingDeleter);
+	for (int x = 0; x < 2 * BATCH; x++)
+		Reclaimer::retire(new int(x), countingDeleter);
+	assert(!pinnedFreed);
+	retired = true;
+	nester.join();
+	for (int x = 0; x < 2 * BATCH; x++)
+		Reclaimer::retire(new int(x), countingDeleter);
+	assert(pinnedFreed);
+
+	cout << "Testing callbacks that call back into the list...\n";
+	{
+		LockFreeLL<int, Reclaimer> reentrant;
+		const int KEYS = 64;
+		atomic<bool> done(false);
+		thread churner([&] {
+			for (int r = 0; !done; r++) {
+				reentrant.add(KEYS + r % KEYS);
+				reentrant.remove(KEYS + (r + 7) % KEYS);
+			}
+		});
+		for (int r = 0; r < 20'000; r++) {
+			int key = r % KEYS;
+			reentrant.findOrEmplace(key, std::hash<int>()(key), [&](int &) {
+				int search = KEYS + r % KEYS;
+				if (reentrant.find(search))
+					assert(search == KEYS + r % KEYS);
+			}, key);
+		}
+		done = true;
+		churner.join();
+	}
+
+	cout << "Testing threaded add/remove churn...\n";
+	LockFreeLL<int, Reclaimer> list;
+	const int THREADS = 4, KEYS = 64, ROUNDS = 20'000;
+	vector<thread> jobs;
+	for (int t = 0; t < THREADS; t++) {
+		jobs.emplace_back([&list, t] {
+			for (int r = 0; r < ROUNDS; r++) {
+				int key = (r * 7 + t) % KEYS;
+				if (r & 1) {
+					list.add(key);
+				} else {
+					list.remove(key);
+				}
+				int search = (key + 1) % KEYS;
+				if (list.find(search))
+					assert(search == (key + 1) % KEYS);
+			}
+		});
+	}
+	for (thread &t : jobs)
+		t.join();
+	jobs.clear();
+
+	cout << "Checking size and connectivity...\n";
+	int live = 0;
+	for (int key = 0; key < KEYS; key++) {
+		int search = key;
+		live += list.find(search);
+	}
+	assert(list.size() == (size_t)live);
+}
+
+int main() {
+	cout << "\n\nRECLAMATION TESTING...\n\n";
+
+	cout << "\nEPOCH BASED\n";
+	cout << "-----------\n";
+	testPolicy<reclaim::EpochBased>();
+
+	cout << "\nHAZARD POINTERS\n";
+	cout << "---------------\n";
+	testPolicy<reclaim::HazardPointers>();
+
+	cout << "\nSuccess :D\n";
+	return 0;
+}
@@ -0,0 +1,173 @@
+#include <assert.h>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <iostream>
+#include "../src/LinkedList.h"
+#include "../src/Hashmap.h"
+
+using std::vector;
+using std::thread;
+using std::cout;
+
+using ll::SeqLockLL;
+
+int main() {
+	cout << "\n\nSEQLOCK LINKED LIST TESTING...\n\n";
+	/*
+	 * SEQUENTIAL TESTING
+	 */
+	cout << "\nBEGINNING SEQUENTIAL CHECKS\n";
+	cout << "---------------------------\n";
+	cout << "Testing sequential add...\n";
+	SeqLockLL<int> sequentialList;
+	assert(sequentialList.size() == 0);
+	int missing = 0;
+	assert(!sequentialList.find(missing) && !sequentialList.remove(0));
+	assert(sequentialList.NOT_THREAD_SAFE_getHead() == nullptr);
+	for (int x = 0; x < 10; x++)
+		sequentialList.add(x);
+	assert(sequentialList.size() == 10);
+	for (int x = 0; x < 10; x++) {
+		int search = x;
+		assert(sequentialList.find(search) && search == x);
+	}
+
+	cout << "Testing sequential remove...\n";
+	for (int x = 0; x < 10; x += 2)
+		assert(sequentialList.remove(x));
+	assert(sequentialList.size() == 5);
+	for (int x = 0; x < 10; x++) {
+		int search = x;
+		bool found = sequentialList.find(search);
+		if (x & 1) assert(found && search == x);
+		else assert(!found);
+	}
+
+	cout << "Testing sequential forEach...\n";
+	int sum = 0;
+	sequentialList.forEach([&sum](const int &x) { sum += x; });
+	assert(sum == 1 + 3 + 5 + 7 + 9);
+
+	cout << "Testing sequential remove full...\n";
+	for (int x = 1; x < 10; x += 2)
+		assert(sequentialList.remove(x));
+	assert(sequentialList.size() == 0);
+	assert(sequentialList.NOT_THREAD_SAFE_getHead() == nullptr);
+
+	/*
+	 * THREADED TESTING
+	 */
+	SeqLockLL<int> threadedList;
+	vector<thread> jobs;
+
+	auto addWorker = [&threadedList](int start, int lim, int inc) {
+		for (int x = start; x < lim; x += inc)
+			threadedList.add(x);
+	};
+
+	auto checkWorker = [&threadedList](int start, int lim, int inc, bool exists) {
+		for (int x = start; x < lim; x += inc) {
+			int search = x;
+			bool found = threadedList.find(search);
+			if (exists) assert(found && search == x);
+			else assert(!found);
+		}
+	};
+
+	auto removeWorker = [&threadedList](int start, int lim, int inc) {
+		for (int x = start; x < lim; x += inc)
+			assert(threadedList.remove(x));
+	};
+
+	const int THREADS = 4, LIM = 1'000;
+	cout << "\nBEGINNING THREADED CHECKS\n";
+	cout << "Threads: " << THREADS << "\n";
+	cout << "Elements: " << LIM << "\n";
+	cout << "-------------------------\n";
+	cout << "Testing threaded add...\n";
+	for (int thread = 0; thread < THREADS; thread++)
+		jobs.emplace_back(addWorker, thread, LIM, THREADS);
+	for (thread &t : jobs)
+		t.join();
+	jobs.clear();
+
+	cout << "Checking size and connectivity...\n";
+	assert(threadedList.size() == LIM);
+	auto *curr = threadedList.NOT_THREAD_SAFE_getHead();
+	int found = 0;
+	while (curr != nullptr)
+		curr = curr->next.load(), found++;
+	assert(found == LIM);
+
+	cout << "Checking threaded containment...\n";
+	for (int thread = 0; thread < THREADS; thread++)
+		jobs.emplace_back(checkWorker, thread, LIM, THREADS, true);
+	for (thread &t : jobs)
+		t.join();
+	jobs.clear();
+
+	cout << "Testing reads racing writers...\n";
+	// Odd keys stay put while writers churn the even ones around them,
+	// so readers keep retrying and falling back to the lock
+	std::atomic<bool> done(false);
+	for (int thread = 0; thread < THREADS; thread++) {
+		jobs.emplace_back([&threadedList, &done, thread] {
+			while (!done.load()) {
+				for (int x = 1 + 2 * thread; x < LIM; x += 2 * THREADS) {
+					int search = x;
+					assert(threadedList.find(search) && search == x);
+				}
+			}
+		});
+	}
+	for (int round = 0; round < 20; round++) {
+		for (int x = 0; x < LIM; x += 2)
+			assert(threadedList.remove(x));
+		for (int x = 0; x < LIM; x += 2)
+			threadedList.add(x);
+	}
+	done = true;
+	for (thread &t : jobs)
+		t.join();
+	jobs.clear();
+	assert(threadedList.size() == LIM);
+
+	cout << "Testing threaded removal...\n";
+	for (int thread = 0; thread < THREADS; thread++)
+		jobs.emplace_back(removeWorker, thread, LIM, THREADS);
+	for (thread &t : jobs)
+		t.join();
+	jobs.clear();
+
+	cout << "Testing containment after removal...\n";
+	for (int thread = 0; thread < THREADS; thread++)
+		jobs.emplace_back(checkWorker, thread, LIM, THREADS, false);
+	for (thread &t : jobs)
+		t.join();
+	jobs.clear();
+
+	cout << "Testing as hashmap buckets...\n";
+	tshm::Hashmap<int, long, ll::SeqLockLL> map(64);
+	for (int x = 0; x < LIM; x++)
+		map.put(x, x);
+	for (int thread = 0; thread < THREADS; thread++) {
+		jobs.emplace_back([&map, thread] {
+			for (int x = thread; x < LIM; x += THREADS) {
+				map.fetchAdd(x, 1);
+				auto [contained, value] = map.get(x);
+				assert(contained && value == x + 1);
+			}
+		});
+	}
+	for (thread &t : jobs)
+		t.join();
+	jobs.clear();
+	for (int x = 0; x < LIM; x += 2)
+		assert(map.remove(x));
+	for (int x = 0; x < LIM; x++)
+		assert(map.get(x).first == (x & 1));
+
+	cout << "\nSuccess :D\n";
+	return 0;
+}
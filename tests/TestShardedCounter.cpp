@@ -0,0 +1,70 @@
+#include <iostream>
+#include <assert.h>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include "../src/ShardedCounter.h"
+
+using std::cout;
+using std::vector;
+using std::thread;
+
+using counter::ShardedCounter;
+
+int main() {
+	cout << "\n\nSHARDED COUNTER TESTING...\n\n";
+
+	cout << "Testing shard count...\n";
+	assert(ShardedCounter(32, 1).shardCount() == 1);
+	assert(ShardedCounter(32, 5).shardCount() == 8);
+	assert(ShardedCounter(32, 16).shardCount() == 16);
+
+	cout << "Testing sequential counts...\n";
+	ShardedCounter single(4, 1);
+	assert(single.exact() == 0 && single.approximate() == 0);
+	for (int i = 0; i < 10; i++)
+		single.increment();
+	assert(single.exact() == 10);
+	assert(single.approximate() > 10 - 4 && single.approximate() <= 10);
+	for (int i = 0; i < 15; i++)
+		single.decrement();
+	assert(single.exact() == -5);
+	assert(single.approximate() > -5 - 4 && single.approximate() < -5 + 4);
+	single.add(100);
+	assert(single.exact() == 95 && single.approximate() == 95);
+
+	cout << "Testing threaded counts...\n";
+	const int THREADS = 20, OPS = 100'000, THRESHOLD = 32;
+	ShardedCounter shared(THRESHOLD, 4);
+	vector<thread> jobs;
+	for (int t = 0; t < THREADS; t++) {
+		jobs.emplace_back([&shared, t] {
+			// Odd threads give back a third of what they add
+			for (int i = 0; i < OPS; i++) {
+				shared.increment();
+				if (t & 1 && i % 3 == 0)
+					shared.decrement();
+			}
+		});
+	}
+	for (thread &t : jobs)
+		t.join();
+
+	long expected = (long)THREADS * OPS - (THREADS / 2) * ((OPS + 2) / 3);
+	assert(shared.exact() == expected);
+	long drift = shared.exact() - shared.approximate();
+	assert(drift < THRESHOLD * (long)shared.shardCount() && -drift < THRESHOLD * (long)shared.shardCount());
+	long estimateDrift = shared.exact() - shared.estimate();
+	assert(estimateDrift * 15 < expected && -estimateDrift * 15 < expected);
+
+	cout << "Testing estimates of small counts...\n";
+	ShardedCounter small(THRESHOLD, 4);
+	for (int i = 0; i < 20; i++)
+		small.increment();
+	assert(small.approximate() == 0 && small.estimate() == 20);
+	small.add(-30);
+	assert(small.estimate() == -10);
+
+	cout << "\nSuccess :D\n";
+	return 0;
+}
@@ -0,0 +1,122 @@
+#include <iostream>
+#include <string>
+#include <assert.h>
+#include <functional>
+#include <set>
+#include <vector>
+#include <thread>
+#include "../src/SplitOrderedHashmap.h"
+
+using std::cout;
+using std::string;
+using std::set;
+using std::vector;
+using std::thread;
+
+using tshm::SplitOrderedHashmap;
+
+int main() {
+	cout << "\n\nSPLIT ORDERED HASHMAP TESTING...\n\n";
+
+	cout << "Testing single value...\n";
+	SplitOrderedHashmap<string, int> hashmap(4);
+	hashmap.put("test", 5);
+	auto [contained, value] = hashmap.get("test");
+	assert(contained && value == 5);
+	assert(!hashmap.get("testy").first);
+
+	cout << "Testing overwrite...\n";
+	hashmap.put("test", 6);
+	assert(hashmap.get("test").second == 6);
+	assert(hashmap.size() == 1);
+
+	cout << "Testing remove...\n";
+	assert(hashmap.remove("test"));
+	assert(!hashmap.remove("test"));
+	assert(!hashmap.get("test").first);
+	assert(hashmap.size() == 0);
+
+	cout << "Testing sequential growth...\n";
+	SplitOrderedHashmap<int, int> growing(2, 1.0);
+	assert(growing.buckets() == 2);
+	for (int x = 0; x < 1'000; x++)
+		growing.put(x, x * 2);
+	assert(growing.size() == 1'000);
+	assert(growing.buckets() >= 512);
+	for (int x = 0; x < 1'000; x++) {
+		auto [contained, value] = growing.get(x);
+		assert(contained && value == x * 2);
+	}
+	assert(!growing.get(1'000).first);
+
+	// Generate 1,000 random unique strings for testing
+	set<string> seen;
+	for (int i = 0; i < 1'000; i++) {
+		string str;
+		do {
+			str = "";
+			for (int j = 0; j < 5; j++)
+				str += 'a' + (rand() % 26);
+		} while (!(seen.insert(str).second));
+	}
+	vector<string> rands(seen.begin(), seen.end());
+
+	// Start tiny so that threads race with resizes
+	SplitOrderedHashmap<string, int> threaded(1);
+
+	auto putJob = [&](int start, int end) {
+		for (int i = start; i <= end; i++)
+			threaded.put(rands[i], i);
+	};
+
+	auto getJob = [&](int start, int end, bool exists) {
+		for (int i = start; i <= end; i++) {
+			auto [contained, value] = threaded.get(rands[i]);
+			if (exists) assert(contained && value == i);
+			else assert(!contained);
+		}
+	};
+
+	auto removeJob = [&](int start, int end) {
+		for (int i = start; i <= end; i++)
+			assert(threaded.remove(rands[i]));
+	};
+
+	cout << "Testing threaded put...\n";
+	vector<thread> threads;
+	for (int i = 0; i < 10; i++)
+		threads.emplace_back(putJob, i*100, i*100 + 99);
+	for (thread &t : threads)
+		t.join();
+	threads.clear();
+	assert(threaded.size() == 1'000);
+	assert(threaded.buckets() >= 256);
+
+	cout << "Testing threaded get...\n";
+	for (int i = 0; i < 10; i++)
+		threads.emplace_back(getJob, i*100, i*100 + 99, true);
+	for (thread &t : threads)
+		t.join();
+	threads.clear();
+
+	cout << "Testing threaded remove...\n";
+	for (int i = 0; i < 10; i++)
+		threads.emplace_back(removeJob, i*100, i*100 + 49);
+	for (thread &t : threads)
+		t.join();
+	threads.clear();
+	assert(threaded.size() == 500);
+
+	cout << "Testing containment after removal...\n";
+	for (int i = 0; i < 10; i++) {
+		threads.emplace_back(getJob, i*100, i*100 + 49, false);
+		threads.emplace_back(getJob, i*100 + 50, i*100 + 99, true);
+	}
+	for (thread &t : threads)
+		t.join();
+	threads.clear();
+
+	cout << "\nSuccess :D\n";
+
+	return 0;
+}
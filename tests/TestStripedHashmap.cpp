@@ -0,0 +1,150 @@
+#include <iostream>
+#include <string>
+#include <assert.h>
+#include <functional>
+#include <set>
+#include <vector>
+#include <thread>
+#include "../src/StripedHashmap.h"
+
+using std::cout;
+using std::string;
+using std::set;
+using std::vector;
+using std::thread;
+
+using tshm::StripedHashmap;
+
+int main() {
+	cout << "\n\nSTRIPED HASHMAP TESTING...\n\n";
+
+	cout << "Testing single value...\n";
+	StripedHashmap<string, int> hashmap(5'000, 16);
+	assert(hashmap.stripeCount() == 16);
+	hashmap.put("test", 5);
+	auto [contained, value] = hashmap.get("test");
+	assert(contained && value == 5);
+	assert(!hashmap.get("testy").first);
+
+	cout << "Testing overwrite...\n";
+	hashmap.put("test", 6);
+	assert(hashmap.get("test").second == 6);
+	assert(hashmap.size() == 1);
+
+	cout << "Testing remove and re-add...\n";
+	assert(hashmap.remove("test"));
+	assert(!hashmap.remove("test"));
+	assert(!hashmap.get("test").first);
+	assert(hashmap.size() == 0);
+	hashmap.put("test", 7);
+	assert(hashmap.get("test").second == 7);
+	assert(hashmap.size() == 1);
+
+	cout << "Testing try_emplace and compute...\n";
+	StripedHashmap<int, int> counters(64, 4);
+	assert(counters.try_emplace(1, 10) && !counters.try_emplace(1, 20));
+	assert(counters.get(1).second == 10);
+	assert(counters.compute(2, [](const int &current) { return current + 5; }) == 5);
+	vector<thread> incrementers;
+	for (int t = 0; t < 20; t++) {
+		incrementers.emplace_back([&] {
+			for (int i = 0; i < 1'000; i++)
+				counters.compute(i % 10, [](const int &current) { return current + 1; });
+		});
+	}
+	for (thread &t : incrementers)
+		t.join();
+	assert(counters.get(0).second == 2'000 && counters.get(1).second == 2'010);
+	assert(counters.get(2).second == 2'005 && counters.size() == 10);
+
+	cout << "Testing visit...\n";
+	int visited = 0;
+	assert(counters.visit(3, [&visited](const int &value) { visited = value; }));
+	assert(visited == 2'000 && !counters.visit(11, [](const int &) {}));
+
+	// Generate 1,000 random unique strings for testing
+	set<string> seen;
+	for (int i = 0; i < 1'000; i++) {
+		string str;
+		do {
+			str = "";
+			for (int j = 0; j < 5; j++)
+				str += 'a' + (rand() % 26);
+		} while (!(seen.insert(str).second));
+	}
+	vector<string> rands(seen.begin(), seen.end());
+
+	// Keep it tight so chains get long and stripes are shared
+	StripedHashmap<string, int> threaded(256, 8);
+
+	auto putJob = [&](int start, int end, int offset) {
+		for (int i = start; i <= end; i++)
+			threaded.put(rands[i], i + offset);
+	};
+
+	auto getJob = [&](int start, int end, bool exists) {
+		for (int i = start; i <= end; i++) {
+			auto [contained, value] = threaded.get(rands[i]);
+			if (exists) assert(contained && value == i);
+			else assert(!contained);
+		}
+	};
+
+	auto removeJob = [&](int start, int end) {
+		for (int i = start; i <= end; i++)
+			assert(threaded.remove(rands[i]));
+	};
+
+	cout << "Testing threaded put...\n";
+	vector<thread> threads;
+	for (int i = 0; i < 10; i++) {
+		threads.emplace_back(putJob, i*100, i*100 + 99, 1);
+		threads.emplace_back(putJob, i*100, i*100 + 99, 1);
+	}
+	for (thread &t : threads)
+		t.join();
+	threads.clear();
+	assert(threaded.size() == 1'000);
+
+	cout << "Testing threaded overwrites during reads...\n";
+	for (int i = 0; i < 10; i++) {
+		threads.emplace_back(putJob, i*100, i*100 + 99, 0);
+		threads.emplace_back([&, i] {
+			for (int j = i*100; j <= i*100 + 99; j++) {
+				auto [contained, value] = threaded.get(rands[j]);
+				assert(contained && (value == j || value == j + 1));
+			}
+		});
+	}
+	for (thread &t : threads)
+		t.join();
+	threads.clear();
+
+	cout << "Testing threaded get...\n";
+	for (int i = 0; i < 10; i++)
+		threads.emplace_back(getJob, i*100, i*100 + 99, true);
+	for (thread &t : threads)
+		t.join();
+	threads.clear();
+
+	cout << "Testing threaded remove...\n";
+	for (int i = 0; i < 10; i++)
+		threads.emplace_back(removeJob, i*100, i*100 + 49);
+	for (thread &t : threads)
+		t.join();
+	threads.clear();
+	assert(threaded.size() == 500);
+
+	cout << "Testing containment after removal...\n";
+	for (int i = 0; i < 10; i++) {
+		threads.emplace_back(getJob, i*100, i*100 + 49, false);
+		threads.emplace_back(getJob, i*100 + 50, i*100 + 99, true);
+	}
+	for (thread &t : threads)
+		t.join();
+	threads.clear();
+
+	cout << "\nSuccess :D\n";
+
+	return 0;
+}
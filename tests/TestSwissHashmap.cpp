@@ -0,0 +1,203 @@
+#include <iostream>
+#include <string>
+#include <assert.h>
+#include <functional>
+#include <stdexcept>
+#include <set>
+#include <vector>
+#include <thread>
+#include "../src/SwissHashmap.h"
+
+using std::cout;
+using std::string;
+using std::set;
+using std::vector;
+using std::thread;
+
+using tshm::SwissHashmap;
+
+int main() {
+	cout << "\n\nSWISS HASHMAP TESTING...\n\n";
+
+	cout << "Testing single value...\n";
+	SwissHashmap<string, int> hashmap(5'000);
+	assert(hashmap.slotCount() == 8'192);
+	hashmap.put("test", 5);
+	auto [contained, value] = hashmap.get("test");
+	assert(contained && value == 5);
+	assert(!hashmap.get("testy").first);
+
+	cout << "Testing overwrite...\n";
+	hashmap.put("test", 6);
+	assert(hashmap.get("test").second == 6);
+	assert(hashmap.size() == 1);
+
+	cout << "Testing remove and revive...\n";
+	assert(hashmap.remove("test"));
+	assert(!hashmap.remove("test"));
+	assert(!hashmap.get("test").first);
+	assert(hashmap.size() == 0);
+	hashmap.put("test", 7);
+	assert(hashmap.get("test").second == 7);
+	assert(hashmap.size() == 1);
+
+	cout << "Testing full table...\n";
+	SwissHashmap<int, int> tiny(4);
+	assert(tiny.slotCount() == 16);
+	for (int x = 0; x < 16; x++)
+		tiny.put(x, x);
+	tiny.put(2, 20);
+	assert(tiny.remove(3));
+	tiny.put(3, 30);
+	bool threw = false;
+	try {
+		tiny.put(16, 16);
+	} catch (const std::length_error &) {
+		threw = true;
+	}
+	assert(threw);
+	assert(tiny.get(2).second == 20 && tiny.get(3).second == 30);
+	assert(!tiny.get(16).first && !tiny.remove(16));
+
+	cout << "Testing probing past full groups...\n";
+	SwissHashmap<int, int> spilled(64);
+	for (int x = 0; x < 64; x++)
+		spilled.put(x, -x);
+	for (int x = 0; x < 128; x++) {
+		auto [found, val] = spilled.get(x);
+		assert(found == (x < 64) && val == (x < 64 ? -x : 0));
+	}
+	assert(spilled.size() == 64);
+
+	cout << "Testing churn over distinct keys...\n";
+	SwissHashmap<int, int> churned(4);
+	for (int x = 0; x < 10'000; x++) {
+		churned.put(x, x);
+		if (x >= 15)
+			assert(churned.remove(x - 15));
+	}
+	assert(churned.size() == 15);
+	assert(churned.get(9'999).second == 9'999 && !churned.get(9'984).first);
+
+	// Generate 1,000 random unique strings for testing
+	set<string> seen;
+	for (int i = 0; i < 1'000; i++) {
+		string str;
+		do {
+			str = "";
+			for (int j = 0; j < 5; j++)
+				str += 'a' + (rand() % 26);
+		} while (!(seen.insert(str).second));
+	}
+	vector<string> rands(seen.begin(), seen.end());
+
+	// Keep it tight so probe chains get long
+	SwissHashmap<string, int> threaded(1'024);
+
+	auto putJob = [&](int start, int end, int offset) {
+		for (int i = start; i <= end; i++)
+			threaded.put(rands[i], i + offset);
+	};
+
+	auto getJob = [&](int start, int end, bool exists) {
+		for (int i = start; i <= end; i++) {
+			auto [contained, value] = threaded.get(rands[i]);
+			if (exists) assert(contained && value == i);
+			else assert(!contained);
+		}
+	};
+
+	auto removeJob = [&](int start, int end) {
+		for (int i = start; i <= end; i++)
+			assert(threaded.remove(rands[i]));
+	};
+
+	cout << "Testing threaded put...\n";
+	vector<thread> threads;
+	for (int i = 0; i < 10; i++) {
+		threads.emplace_back(putJob, i*100, i*100 + 99, 1);
+		threads.emplace_back(putJob, i*100, i*100 + 99, 1);
+	}
+	for (thread &t : threads)
+		t.join();
+	threads.clear();
+	assert(threaded.size() == 1'000);
+
+	cout << "Testing threaded overwrites during reads...\n";
+	for (int i = 0; i < 10; i++) {
+		threads.emplace_back(putJob, i*100, i*100 + 99, 0);
+		threads.emplace_back([&, i] {
+			for (int j = i*100; j <= i*100 + 99; j++) {
+				auto [contained, value] = threaded.get(rands[j]);
+				assert(contained && (value == j || value == j + 1));
+			}
+		});
+	}
+	for (thread &t : threads)
+		t.join();
+	threads.clear();
+
+	cout << "Testing threaded get...\n";
+	for (int i = 0; i < 10; i++)
+		threads.emplace_back(getJob, i*100, i*100 + 99, true);
+	for (thread &t : threads)
+		t.join();
+	threads.clear();
+
+	cout << "Testing threaded remove...\n";
+	for (int i = 0; i < 10; i++)
+		threads.emplace_back(removeJob, i*100, i*100 + 49);
+	for (thread &t : threads)
+		t.join();
+	threads.clear();
+	assert(threaded.size() == 500);
+
+	cout << "Testing containment after removal...\n";
+	for (int i = 0; i < 10; i++) {
+		threads.emplace_back(getJob, i*100, i*100 + 49, false);
+		threads.emplace_back(getJob, i*100 + 50, i*100 + 99, true);
+	}
+	for (thread &t : threads)
+		t.join();
+	threads.clear();
+
+	cout << "Testing threaded churn over distinct keys...\n";
+	SwissHashmap<string, int> tight(64);
+	for (int i = 0; i < 8; i++) {
+		threads.emplace_back([&tight, i] {
+			for (int j = 0; j < 2'000; j++) {
+				string key = std::to_string(i) + "-" + std::to_string(j);
+				tight.put(key, j);
+				assert(tight.get(key).second == j);
+				assert(tight.remove(key));
+			}
+		});
+	}
+	for (thread &t : threads)
+		t.join();
+	threads.clear();
+	assert(tight.size() == 0);
+
+	cout << "Testing threaded adds of the same keys during churn...\n";
+	SwissHashmap<int, int> shared(64);
+	for (int i = 0; i < 8; i++) {
+		threads.emplace_back([&shared, i] {
+			for (int j = 0; j < 2'000; j++) {
+				shared.put(j % 16, j);
+				shared.put(16 + i * 2'000 + j, j);
+				assert(shared.remove(16 + i * 2'000 + j));
+			}
+		});
+	}
+	for (thread &t : threads)
+		t.join();
+	threads.clear();
+	assert(shared.size() == 16);
+	for (int x = 0; x < 16; x++)
+		assert(shared.remove(x) && !shared.remove(x));
+	assert(shared.size() == 0);
+
+	cout << "\nSuccess :D\n";
+
+	return 0;
+}
@@ -0,0 +1,91 @@
+#include <assert.h>
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <iostream>
+#include "../src/WorkQueue.h"
+
+using std::vector;
+using std::thread;
+using std::cout;
+using std::atomic;
+
+using queue::MPMCQueue;
+
+int main() {
+	cout << "\n\nWORK QUEUE TESTING...\n\n";
+	/*
+	 * SEQUENTIAL TESTING
+	 */
+	cout << "\nBEGINNING SEQUENTIAL CHECKS\n";
+	cout << "---------------------------\n";
+	cout << "Testing push and pop order...\n";
+	MPMCQueue<int> sequentialQueue(10);
+	assert(sequentialQueue.capacity() == 16);
+	assert(sequentialQueue.empty());
+	int out;
+	assert(!sequentialQueue.tryPop(out));
+	for (int x = 0; x < 16; x++)
+		assert(sequentialQueue.tryPush(x));
+	assert(!sequentialQueue.tryPush(16));
+	assert(!sequentialQueue.empty());
+	for (int x = 0; x < 16; x++)
+		assert(sequentialQueue.tryPop(out) && out == x);
+	assert(sequentialQueue.empty());
+
+	cout << "Testing batched pops across laps...\n";
+	int batch[8];
+	for (int lap = 0; lap < 5; lap++) {
+		for (int x = 0; x < 12; x++)
+			assert(sequentialQueue.tryPush(lap * 100 + x));
+		assert(sequentialQueue.tryPopBatch(batch, 8) == 8);
+		for (int x = 0; x < 8; x++)
+			assert(batch[x] == lap * 100 + x);
+		assert(sequentialQueue.tryPopBatch(batch, 8) == 4);
+		for (int x = 0; x < 4; x++)
+			assert(batch[x] == lap * 100 + 8 + x);
+		assert(sequentialQueue.tryPopBatch(batch, 8) == 0);
+	}
+
+	/*
+	 * THREADED TESTING
+	 */
+	const int THREADS = 4, LIM = 100'000;
+	cout << "\nBEGINNING THREADED CHECKS\n";
+	cout << "Threads: " << THREADS << "\n";
+	cout << "Elements: " << LIM << "\n";
+	cout << "-------------------------\n";
+	cout << "Testing threaded push and pop...\n";
+	MPMCQueue<int> threadedQueue(256);
+	vector<atomic<int>> seen(LIM);
+	atomic<int> consumed(0);
+	vector<thread> jobs;
+
+	for (int t = 0; t < THREADS; t++) {
+		jobs.emplace_back([&, t] {
+			for (int x = t; x < LIM; x += THREADS)
+				while (!threadedQueue.tryPush(x));
+		});
+		jobs.emplace_back([&] {
+			int batch[16];
+			while (consumed < LIM) {
+				size_t count = threadedQueue.tryPopBatch(batch, 16);
+				for (size_t i = 0; i < count; i++)
+					seen[batch[i]]++;
+				consumed += count;
+			}
+		});
+	}
+	for (thread &t : jobs)
+		t.join();
+	jobs.clear();
+
+	cout << "Checking every item came out exactly once...\n";
+	assert(consumed == LIM);
+	for (int x = 0; x < LIM; x++)
+		assert(seen[x] == 1);
+	assert(threadedQueue.empty());
+
+	cout << "\nSuccess :D\n";
+	return 0;
+}